@@ -0,0 +1,324 @@
+// Measures the throughput and allocations of parsing and writing on generated corpora.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -O2 -pthread -I. benchmarks/benchmark.cpp -o benchmark && ./benchmark [scale] [repetitions]
+// The corpora are generated from fixed seeds, with values derived from the output of std::mt19937_64 rather than through the distributions
+// of <random>, so every run measures the same input, whichever the standard library. Scale multiplies their size (default 1),
+// and each measurement reports the fastest of its repetitions (default 5).
+
+#define EULERISTIC_JSON_ALLOCATION_HOOKS_IMPLEMENTATION
+#define EULERISTIC_JSON_PARALLEL_WRITES
+#if __has_include(<sys/uio.h>)
+#define EULERISTIC_JSON_POSIX_IO
+#endif //__has_include(<sys/uio.h>)
+#include "euleristic_json.hpp"
+#include "corpus.hpp"
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <cstdlib>
+
+namespace json = euleristic::json;
+using value_t = json::value_type<long long, double, std::string>;
+
+// Corpora
+
+namespace {
+
+	// A document, or many small ones, to measure on, with the JSON Pointers and JSONPath queries typical of it, if any.
+	struct benchmark_corpus {
+		std::string name;
+		std::vector<std::string> documents;
+		std::vector<std::string> pointers = {};
+		std::vector<std::string> paths = {};
+
+		size_t bytes() const {
+			size_t sum = 0;
+			for (auto& document : documents) sum += document.size();
+			return sum;
+		}
+	};
+
+	std::string to_text(const value_t& value) {
+		std::ostringstream stream;
+		stream << value;
+		return std::move(stream).str();
+	}
+
+	// A number in [min, max], as corpus.hpp draws them. The slight bias of the remainder towards small values does not matter here.
+	size_t between(std::mt19937_64& random, size_t min, size_t max) {
+		return min + static_cast<size_t>(random() % (static_cast<uint64_t>(max - min) + 1));
+	}
+
+	// A number in [low, high), from the 53 high bits of the next output.
+	double uniform(std::mt19937_64& random, double low, double high) {
+		return low + (high - low) * (static_cast<double>(random() >> 11) * 0x1.0p-53);
+	}
+
+	std::string random_word(std::mt19937_64& random, size_t min_length, size_t max_length) {
+		static constexpr std::string_view letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 ";
+		std::string word(between(random, min_length, max_length), ' ');
+		for (auto& c : word) c = letters[random() % letters.size()];
+		return word;
+	}
+
+	// Statuses, each with a user and entities, as in the twitter.json commonly used for JSON benchmarks.
+	benchmark_corpus twitter_like(size_t scale) {
+		std::mt19937_64 random(1);
+		std::vector<value_t> statuses;
+		for (size_t i = 0; i < 1000 * scale; ++i) {
+			std::unordered_map<std::string, value_t> user{
+				{ "id", value_t(static_cast<long long>(random() >> 2)) },
+				{ "screen_name", value_t(random_word(random, 6, 15)) },
+				{ "description", value_t(random_word(random, 20, 160)) },
+				{ "followers_count", value_t(static_cast<long long>(random() % 100000)) },
+				{ "verified", value_t(random() % 10 == 0) },
+				{ "url", random() % 2 ? value_t(nullptr) : value_t("https://example.com/" + random_word(random, 4, 12)) }
+			};
+			std::vector<value_t> hashtags;
+			for (size_t j = random() % 4; j > 0; --j) {
+				hashtags.emplace_back(std::unordered_map<std::string, value_t>{
+					{ "text", value_t(random_word(random, 3, 12)) },
+					{ "indices", value_t(std::vector<value_t>{ value_t(static_cast<long long>(random() % 140)), value_t(static_cast<long long>(random() % 140)) }) }
+				});
+			}
+			statuses.emplace_back(std::unordered_map<std::string, value_t>{
+				{ "id", value_t(static_cast<long long>(random() >> 2)) },
+				{ "created_at", value_t(std::string("Sun Aug 31 00:29:15 +0000 2014")) },
+				{ "text", value_t(random_word(random, 10, 140)) },
+				{ "retweet_count", value_t(static_cast<long long>(random() % 1000)) },
+				{ "favorited", value_t(false) },
+				{ "in_reply_to_status_id", value_t(nullptr) },
+				{ "user", value_t(std::move(user)) },
+				{ "entities", value_t(std::unordered_map<std::string, value_t>{ { "hashtags", value_t(std::move(hashtags)) } }) }
+			});
+		}
+		return { "twitter-like", { to_text(value_t(std::unordered_map<std::string, value_t>{ { "statuses", value_t(std::move(statuses)) } })) },
+			{ "/statuses/0/id", "/statuses/0/user/screen_name", "/statuses/500/entities/hashtags", "/statuses/999/user/followers_count" },
+			{ "$.statuses[*].user.screen_name", "$.statuses[?@.retweet_count > 900].id", "$..hashtags[*].text", "$.statuses[::100].text" } };
+	}
+
+	// Polygons of coordinate pairs, as in the number heavy canada.json.
+	benchmark_corpus canada_like(size_t scale) {
+		std::mt19937_64 random(2);
+		std::vector<value_t> features;
+		for (size_t i = 0; i < 20 * scale; ++i) {
+			std::vector<value_t> ring;
+			for (size_t j = 0; j < 2000; ++j) {
+				ring.emplace_back(std::vector<value_t>{ value_t(uniform(random, -141.0, -52.0)), value_t(uniform(random, 41.0, 83.0)) });
+			}
+			features.emplace_back(std::unordered_map<std::string, value_t>{
+				{ "type", value_t(std::string("Feature")) },
+				{ "properties", value_t(std::unordered_map<std::string, value_t>{ { "name", value_t(std::string("Canada")) } }) },
+				{ "geometry", value_t(std::unordered_map<std::string, value_t>{
+					{ "type", value_t(std::string("Polygon")) },
+					{ "coordinates", value_t(std::vector<value_t>{ value_t(std::move(ring)) }) }
+				}) }
+			});
+		}
+		return { "canada-like", { to_text(value_t(std::unordered_map<std::string, value_t>{
+			{ "type", value_t(std::string("FeatureCollection")) },
+			{ "features", value_t(std::move(features)) }
+		})) },
+			{ "/features/0/geometry/coordinates/0/0", "/features/19/properties/name" },
+			{ "$.features[*].properties.name", "$.features[0].geometry.coordinates[0][::100][0]" } };
+	}
+
+	// Long strings, some with escapes.
+	benchmark_corpus string_heavy(size_t scale) {
+		std::mt19937_64 random(3);
+		static constexpr std::string_view escapes[] = { "\n", "\t", "\"", "\\", "/" };
+		std::vector<value_t> entries;
+		for (size_t i = 0; i < 2000 * scale; ++i) {
+			std::string text;
+			for (size_t j = random() % 8 + 1; j > 0; --j) {
+				text += random_word(random, 20, 200);
+				if (random() % 3 == 0) text += escapes[random() % std::size(escapes)];
+			}
+			entries.emplace_back(std::unordered_map<std::string, value_t>{
+				{ "title", value_t(random_word(random, 10, 40)) },
+				{ "body", value_t(std::move(text)) }
+			});
+		}
+		return { "string-heavy", { to_text(value_t(std::move(entries))) } };
+	}
+
+	// Arrays and objects nested within each other, hundreds deep.
+	benchmark_corpus deeply_nested(size_t scale) {
+		std::mt19937_64 random(4);
+		std::vector<value_t> trees;
+		for (size_t i = 0; i < 20 * scale; ++i) {
+			value_t tree(static_cast<long long>(i));
+			for (size_t depth = 0; depth < 300; ++depth) {
+				if (random() % 2) {
+					tree = value_t(std::vector<value_t>{ std::move(tree), value_t(static_cast<long long>(depth)) });
+				}
+				else {
+					tree = value_t(std::unordered_map<std::string, value_t>{ { "child", std::move(tree) }, { "depth", value_t(static_cast<long long>(depth)) } });
+				}
+			}
+			trees.push_back(std::move(tree));
+		}
+		return { "deeply-nested", { to_text(value_t(std::move(trees))) } };
+	}
+
+	// Many small documents, as in a log of events.
+	benchmark_corpus many_small(size_t scale) {
+		std::mt19937_64 random(5);
+		benchmark_corpus result{ "many-small", {} };
+		for (size_t i = 0; i < 20000 * scale; ++i) {
+			result.documents.push_back(to_text(value_t(std::unordered_map<std::string, value_t>{
+				{ "event", value_t(random_word(random, 4, 10)) },
+				{ "timestamp", value_t(static_cast<long long>(1700000000 + i)) },
+				{ "value", value_t(uniform(random, 0.0, 100.0)) },
+				{ "ok", value_t(random() % 2 == 0) }
+			})));
+		}
+		result.pointers = { "/event", "/value" };
+		result.paths = { "$.value", "$[?@ == true]" };
+		return result;
+	}
+
+	// A document of the default shape of corpus::generator, with some non-ASCII characters.
+	benchmark_corpus synthetic(size_t scale) {
+		corpus::shape shape;
+		shape.bytes = (size_t(1) << 20) * scale;
+		shape.non_ascii_ratio = 0.02;
+		corpus::generator generator(6, shape);
+		return { "synthetic", { to_text(generator.document()) } };
+	}
+
+	// Measurement
+
+	// The fastest of repetitions runs of operation, with the allocations it made on the calling thread.
+	struct measurement {
+		double seconds = 0;
+		size_t allocations = 0;
+		size_t allocated_bytes = 0;
+	};
+
+	template <typename operation_t>
+	measurement measure(size_t repetitions, operation_t&& operation) {
+		measurement best{ std::numeric_limits<double>::infinity() };
+		for (size_t i = 0; i < repetitions; ++i) {
+			json::allocation_counter counter;
+			const auto start = std::chrono::steady_clock::now();
+			operation();
+			const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			if (seconds < best.seconds) {
+				best = { seconds, counter.allocations(), counter.allocated_bytes() };
+			}
+		}
+		return best;
+	}
+
+	void report(const benchmark_corpus& input, std::string_view operation, const measurement& result) {
+		std::cout << std::left << std::setw(16) << input.name << std::setw(52) << operation << std::right << std::fixed << std::setprecision(1)
+			<< std::setw(10) << input.bytes() / result.seconds / 1e6 << " MB/s"
+			<< std::setw(12) << input.documents.size() / result.seconds << " docs/s"
+			<< std::setw(12) << result.allocations << " allocs"
+			<< std::setw(14) << result.allocated_bytes << " bytes\n";
+	}
+
+	void run(const benchmark_corpus& input, size_t repetitions) {
+		const auto directory = std::filesystem::temp_directory_path();
+		std::vector<std::filesystem::path> paths;
+		for (size_t i = 0; i < input.documents.size(); ++i) {
+			paths.push_back(directory / ("euleristic_json_benchmark_" + std::to_string(i) + ".json"));
+			std::ofstream(paths.back(), std::ios::binary) << input.documents[i];
+		}
+
+		std::vector<value_t> values(input.documents.size());
+		report(input, "parse_text", measure(repetitions, [&] {
+			for (size_t i = 0; i < input.documents.size(); ++i) values[i] = json::parse_text<long long, double, std::string>(input.documents[i]);
+		}));
+		report(input, "parse_file", measure(repetitions, [&] {
+			for (size_t i = 0; i < paths.size(); ++i) values[i] = json::parse_file<long long, double, std::string>(paths[i]);
+		}));
+		if (input.documents.size() > 1) {
+			std::string lines;
+			for (auto& document : input.documents) lines += document + '\n';
+			report(input, "document_stream", measure(repetitions, [&] {
+				json::document_stream<long long, double, std::string> stream(lines);
+				for (auto& value : stream) values.front() = std::move(value);
+			}));
+			values.front() = json::parse_text<long long, double, std::string>(input.documents.front());
+		}
+
+		if (!input.pointers.empty()) {
+			std::vector<json::json_pointer<std::string>> pointers(input.pointers.cbegin(), input.pointers.cend());
+			size_t found = 0;
+			report(input, "json_pointer::resolve", measure(repetitions, [&] {
+				for (auto& value : values) {
+					for (auto& pointer : pointers) found += pointer.resolve(value) != nullptr;
+				}
+			}));
+			report(input, "json_pointer::resolve_all", measure(repetitions, [&] {
+				for (auto& value : values) found += json::json_pointer<std::string>::resolve_all(value, pointers).size();
+			}));
+			const json::projection<std::string> selection(pointers);
+			report(input, "parse_text (projection)", measure(repetitions, [&] {
+				for (size_t i = 0; i < input.documents.size(); ++i) values[i] = json::parse_text<long long, double, std::string>(input.documents[i], selection);
+			}));
+			for (size_t i = 0; i < input.documents.size(); ++i) values[i] = json::parse_text<long long, double, std::string>(input.documents[i]);
+			if (found == 0) std::cout << "no pointer resolved\n";
+		}
+		for (auto& text : input.paths) {
+			const json::json_path<std::string> path(text);
+			size_t found = 0;
+			report(input, "json_path " + text, measure(repetitions, [&] {
+				for (auto& value : values) found += path.execute(value).size();
+			}));
+			if (found == 0) std::cout << "no value matched " << text << '\n';
+		}
+
+		report(input, "operator<<", measure(repetitions, [&] {
+			for (auto& value : values) {
+				std::ostringstream stream;
+				stream << value;
+			}
+		}));
+		// What writing a file took before write_to_file had a buffer of its own, to compare the rows below with.
+		report(input, "std::ofstream << value", measure(repetitions, [&] {
+			for (size_t i = 0; i < values.size(); ++i) std::ofstream(paths[i]) << values[i];
+		}));
+		report(input, "write_to_file", measure(repetitions, [&] {
+			for (size_t i = 0; i < values.size(); ++i) json::write_to_file(values[i], paths[i]);
+		}));
+		report(input, "write_to_file (atomic)", measure(repetitions, [&] {
+			json::write_options options;
+			options.atomic = true;
+			for (size_t i = 0; i < values.size(); ++i) json::write_to_file(values[i], paths[i], options);
+		}));
+		report(input, "write_to_file (direct)", measure(repetitions, [&] {
+			json::write_options options;
+			options.direct = true;
+			for (size_t i = 0; i < values.size(); ++i) json::write_to_file(values[i], paths[i], options);
+		}));
+		report(input, "write_to_file_parallel", measure(repetitions, [&] {
+			for (size_t i = 0; i < values.size(); ++i) json::write_to_file_parallel(values[i], paths[i]);
+		}));
+
+		for (auto& path : paths) std::filesystem::remove(path);
+	}
+}
+
+int main(int argc, char** argv) {
+	const size_t scale = argc > 1 ? std::max<size_t>(1, std::strtoull(argv[1], nullptr, 10)) : 1;
+	const size_t repetitions = argc > 2 ? std::max<size_t>(1, std::strtoull(argv[2], nullptr, 10)) : 5;
+
+	for (auto generate : { twitter_like, canada_like, string_heavy, deeply_nested, many_small, synthetic }) {
+		const benchmark_corpus input = generate(scale);
+		std::cout << input.name << ": " << input.documents.size() << " documents, " << input.bytes() << " bytes\n";
+		try {
+			run(input, repetitions);
+		}
+		catch (json::parsing_error error) {
+			std::cout << "parsing_error " << static_cast<int>(error.type) << '\n';
+		}
+		catch (json::format_error error) {
+			std::cout << "format_error " << static_cast<int>(error) << '\n';
+		}
+	}
+}
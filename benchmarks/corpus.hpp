@@ -0,0 +1,241 @@
+// Generates JSON of controlled shape from a seed, so that benchmarks and regression inputs are reproducible without downloads.
+// The same seed and shape always give the same output, whichever the standard library, since every value is derived from the output of
+// std::mt19937_64, which the standard fixes, rather than through the distributions of <random>, which it does not. Only the order of
+// members of generated objects may differ between standard libraries, as it is that of std::unordered_map.
+
+#pragma once
+#include "euleristic_json.hpp"
+#include <random>
+#include <ostream>
+
+namespace corpus {
+
+	namespace json = euleristic::json;
+	using value_t = json::value_type<long long, double, std::string>;
+
+	// The shape of generated documents.
+	struct shape {
+		// The approximate size of a document, in bytes of compact JSON.
+		size_t bytes = size_t(1) << 20;
+		// The deepest nesting of arrays and objects below the root.
+		size_t max_depth = 6;
+		// The most elements of an array or members of an object.
+		size_t max_width = 12;
+		// The number of distinct keys, which objects draw their keys from. Fewer keys means more repetition.
+		size_t key_count = 64;
+		// The length of strings, in characters, is uniform between these.
+		size_t min_string_length = 0;
+		size_t max_string_length = 32;
+		// The probability of each character of a string being one which must be escaped.
+		double escape_ratio = 0.01;
+		// The probability of each character of a string being a non-ASCII code point, written as UTF-8.
+		double non_ascii_ratio = 0.0;
+		// The probability of a number being an integer rather than floating point.
+		double integer_ratio = 0.5;
+		// The probability of a value being an array or object, as long as the depth allows it.
+		double container_ratio = 0.3;
+	};
+
+	// Generates values of a shape, from a seed.
+	class generator {
+		std::mt19937_64 _random;
+		shape _shape;
+		std::vector<std::string> _keys;
+
+		// The approximate size of what has been generated since the last document began.
+		size_t _bytes = 0;
+
+		// A number in [0, 1), from the 53 high bits of the next output.
+		double _unit() {
+			return static_cast<double>(_random() >> 11) * 0x1.0p-53;
+		}
+
+		bool _chance(const double probability) {
+			return _unit() < probability;
+		}
+
+		// The slight bias of the remainder towards small values does not matter here.
+		size_t _between(const size_t min, const size_t max) {
+			if (max <= min) {
+				return min;
+			}
+			return min + static_cast<size_t>(_random() % (static_cast<uint64_t>(max - min) + 1));
+		}
+
+		// Appends a code point of the non-ASCII ranges as UTF-8.
+		void _append_non_ascii(std::string& string) {
+			static constexpr char32_t ranges[][2] = { { 0xA0, 0x7FF }, { 0x800, 0xD7FF }, { 0xE000, 0xFFFD }, { 0x10000, 0x10FFFF } };
+			auto& range = ranges[_random() % std::size(ranges)];
+			const auto code_point = static_cast<char32_t>(_between(range[0], range[1]));
+			if (code_point < 0x800) {
+				string += static_cast<char>(0xC0 | (code_point >> 6));
+			}
+			else if (code_point < 0x10000) {
+				string += static_cast<char>(0xE0 | (code_point >> 12));
+				string += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+			}
+			else {
+				string += static_cast<char>(0xF0 | (code_point >> 18));
+				string += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+				string += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+			}
+			string += static_cast<char>(0x80 | (code_point & 0x3F));
+		}
+
+	public:
+		generator(const uint64_t seed, const shape& shape) : _random(seed), _shape(shape) {
+			for (size_t i = 0; i < std::max<size_t>(1, _shape.key_count); ++i) {
+				_keys.push_back(string(1, 16, 0.0, 0.0));
+			}
+		}
+
+		// A string of between min_length and max_length characters, with escapes and non-ASCII code points in the given ratios.
+		std::string string(const size_t min_length, const size_t max_length, const double escape_ratio, const double non_ascii_ratio) {
+			static constexpr std::string_view letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789 _-.";
+			static constexpr std::string_view escaped = "\"\\/\b\f\n\r\t";
+			std::string result;
+			for (size_t length = _between(min_length, max_length); length > 0; --length) {
+				if (_chance(escape_ratio)) {
+					result += escaped[_random() % escaped.size()];
+				}
+				else if (_chance(non_ascii_ratio)) {
+					_append_non_ascii(result);
+				}
+				else {
+					result += letters[_random() % letters.size()];
+				}
+			}
+			return result;
+		}
+
+		// A number, integral or floating point in the ratio of the shape.
+		value_t number() {
+			if (_chance(_shape.integer_ratio)) {
+				// Mostly small integers, as in real data, but sometimes up to 2^53.
+				const long long magnitude = _chance(0.9) ? static_cast<long long>(_random() % 100000) : static_cast<long long>(_random() >> 11);
+				_bytes += 6;
+				return value_t(_chance(0.2) ? -magnitude : magnitude);
+			}
+			_bytes += 10;
+			return value_t(-1e6 + 2e6 * _unit());
+		}
+
+		// A value, which may be an array or object as long as depth is below the maximum depth of the shape.
+		value_t value(const size_t depth) {
+			if (depth < _shape.max_depth && _chance(_shape.container_ratio)) {
+				const size_t width = _between(0, _shape.max_width);
+				_bytes += 2;
+				if (_chance(0.5)) {
+					std::vector<value_t> array;
+					for (size_t i = 0; i < width; ++i) {
+						array.push_back(value(depth + 1));
+						_bytes += 1;
+					}
+					return value_t(std::move(array));
+				}
+				std::unordered_map<std::string, value_t> object;
+				for (size_t i = 0; i < width; ++i) {
+					auto& key = _keys[_random() % _keys.size()];
+					_bytes += key.size() + 4;
+					object.insert_or_assign(key, value(depth + 1));
+				}
+				return value_t(std::move(object));
+			}
+
+			switch (_random() % 8) {
+			case 0:
+				_bytes += 4;
+				return value_t(nullptr);
+			case 1:
+				_bytes += 5;
+				return value_t(_chance(0.5));
+			case 2:
+			case 3:
+			case 4: {
+				auto text = string(_shape.min_string_length, _shape.max_string_length, _shape.escape_ratio, _shape.non_ascii_ratio);
+				_bytes += text.size() + 2;
+				return value_t(std::move(text));
+			}
+			default:
+				return number();
+			}
+		}
+
+		// A document of about the size of the shape: an array of values, which is extended until it is large enough.
+		value_t document() {
+			_bytes = 0;
+			std::vector<value_t> elements;
+			do {
+				elements.push_back(value(1));
+			} while (_bytes < _shape.bytes);
+			return value_t(std::move(elements));
+		}
+	};
+
+	// The names of the pathological cases write_pathological knows.
+	inline constexpr std::string_view pathological_cases[] = {
+		"deep_arrays", "deep_objects", "long_string", "escaped_string", "long_array", "wide_object", "numbers", "empty_containers"
+	};
+
+	// Writes a pathological case of about size elements or characters to stream, through a stream_writer, so that no value_type
+	// of the whole case is built. Returns false if there is no case by that name.
+	// Numbers are written as text laid out as the writer would, since it writes floating point numbers with six decimals, which
+	// would turn the smallest into 0.
+	inline bool write_pathological(const std::string_view name, const size_t size, std::ostream& stream, const uint64_t seed = 0) {
+		json::stream_writer<std::string> writer(stream);
+		generator random(seed, {});
+
+		if (name == "deep_arrays") {
+			for (size_t i = 0; i < size; ++i) writer.begin_array();
+			for (size_t i = 0; i < size; ++i) writer.end_array();
+		}
+		else if (name == "deep_objects") {
+			for (size_t i = 0; i < size; ++i) writer.begin_object().key("a");
+			writer.value(nullptr);
+			for (size_t i = 0; i < size; ++i) writer.end_object();
+		}
+		else if (name == "long_string") {
+			writer.value(random.string(size, size, 0.0, 0.0));
+		}
+		else if (name == "escaped_string") {
+			writer.value(random.string(size, size, 1.0, 0.0));
+		}
+		else if (name == "long_array") {
+			writer.begin_array();
+			for (size_t i = 0; i < size; ++i) writer.value(static_cast<long long>(i % 10));
+			writer.end_array();
+		}
+		else if (name == "wide_object") {
+			writer.begin_object();
+			for (size_t i = 0; i < size; ++i) writer.key("k" + std::to_string(i)).value(static_cast<long long>(i));
+			writer.end_object();
+		}
+		else if (name == "numbers") {
+			// 0, -1, the extremes of long long and 2^53 + 1.
+			constexpr std::string_view integers[] = { "0", "-1", "9223372036854775807", "-9223372036854775808", "9007199254740993" };
+			// 0, -0, 0.1, and the minimum, maximum, lowest, smallest denormal and epsilon of double, each as text which reads back exactly
+			// and has a decimal point, so that it is read as floating point.
+			constexpr std::string_view floating_points[] = { "0.0", "-0.0", "0.1", "2.2250738585072014e-308", "1.7976931348623157e+308",
+				"-1.7976931348623157e+308", "4.9406564584124654e-324", "2.220446049250313e-16" };
+			stream << '[';
+			for (size_t i = 0; i < size; ++i) {
+				stream << (i ? ",\n\t" : "\n\t") << (i % 2 ? integers[(i / 2) % std::size(integers)] : floating_points[(i / 2) % std::size(floating_points)]);
+			}
+			stream << (size ? "\n]" : "]");
+		}
+		else if (name == "empty_containers") {
+			writer.begin_array();
+			for (size_t i = 0; i < size; ++i) {
+				if (i % 3 == 0) writer.begin_array().end_array();
+				else if (i % 3 == 1) writer.begin_object().end_object();
+				else writer.begin_array().begin_object().end_object().end_array();
+			}
+			writer.end_array();
+		}
+		else {
+			return false;
+		}
+		stream << '\n';
+		return true;
+	}
+}
@@ -0,0 +1,104 @@
+// Writes generated JSON of controlled shape to a file, from a seed, so that inputs are reproducible without downloads.
+// Build from the root of the repository:
+//     g++ -std=c++20 -O2 -I. benchmarks/generate_corpus.cpp -o generate_corpus
+// Usage:
+//     generate_corpus document <seed> <path> [option=value...]        one document of the shape
+//     generate_corpus ndjson <seed> <path> <count> [option=value...]  count documents of the shape, one per line
+//     generate_corpus pathological <case> <path> <size>               one of the pathological cases, see corpus.hpp
+// The options set the fields of corpus::shape: bytes, max_depth, max_width, key_count, min_string_length, max_string_length,
+// escape_ratio, non_ascii_ratio, integer_ratio and container_ratio.
+
+#include "corpus.hpp"
+#include <iostream>
+#include <cstdlib>
+
+namespace {
+
+	// Sets the field of shape named by an option of the form name=value, or returns false if there is no such field.
+	bool set_option(corpus::shape& shape, const std::string_view option) {
+		const auto separator = option.find('=');
+		if (separator == std::string_view::npos) {
+			return false;
+		}
+		const auto name = option.substr(0, separator);
+		const std::string value(option.substr(separator + 1));
+
+		const std::pair<std::string_view, size_t*> sizes[] = {
+			{ "bytes", &shape.bytes }, { "max_depth", &shape.max_depth }, { "max_width", &shape.max_width }, { "key_count", &shape.key_count },
+			{ "min_string_length", &shape.min_string_length }, { "max_string_length", &shape.max_string_length }
+		};
+		const std::pair<std::string_view, double*> ratios[] = {
+			{ "escape_ratio", &shape.escape_ratio }, { "non_ascii_ratio", &shape.non_ascii_ratio },
+			{ "integer_ratio", &shape.integer_ratio }, { "container_ratio", &shape.container_ratio }
+		};
+		for (auto& [field, target] : sizes) {
+			if (name == field) {
+				*target = std::strtoull(value.c_str(), nullptr, 10);
+				return true;
+			}
+		}
+		for (auto& [field, target] : ratios) {
+			if (name == field) {
+				*target = std::strtod(value.c_str(), nullptr);
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int usage() {
+		std::cerr << "usage: generate_corpus document <seed> <path> [option=value...]\n"
+			<< "       generate_corpus ndjson <seed> <path> <count> [option=value...]\n"
+			<< "       generate_corpus pathological <case> <path> <size>\n"
+			<< "cases:";
+		for (auto name : corpus::pathological_cases) std::cerr << ' ' << name;
+		std::cerr << '\n';
+		return 1;
+	}
+}
+
+int main(int argc, char** argv) {
+	if (argc < 4) {
+		return usage();
+	}
+	const std::string_view mode = argv[1];
+	std::ofstream file(argv[3], std::ios::binary);
+	if (!file) {
+		std::cerr << "could not open " << argv[3] << '\n';
+		return 1;
+	}
+
+	if (mode == "pathological") {
+		if (argc < 5 || !corpus::write_pathological(argv[2], std::strtoull(argv[4], nullptr, 10), file)) {
+			return usage();
+		}
+		return 0;
+	}
+
+	const uint64_t seed = std::strtoull(argv[2], nullptr, 10);
+	const bool ndjson = mode == "ndjson";
+	if ((!ndjson && mode != "document") || (ndjson && argc < 5)) {
+		return usage();
+	}
+
+	corpus::shape shape;
+	for (int i = ndjson ? 5 : 4; i < argc; ++i) {
+		if (!set_option(shape, argv[i])) {
+			std::cerr << "unknown option " << argv[i] << '\n';
+			return usage();
+		}
+	}
+	corpus::generator generator(seed, shape);
+
+	if (ndjson) {
+		// NDJSON needs one document per line, which the canonical form gives.
+		for (size_t i = std::strtoull(argv[4], nullptr, 10); i > 0; --i) {
+			file << corpus::json::to_canonical(generator.document()) << '\n';
+		}
+	}
+	else {
+		corpus::json::stream_writer<std::string>(file).value(generator.document());
+		file << '\n';
+	}
+	return 0;
+}
@@ -22,6 +22,7 @@
 
 #pragma once
 #include <unordered_map>
+#include <unordered_set>
 #include <map>
 #include <span>
 #include <vector>
@@ -33,10 +34,40 @@
 #include <concepts>
 #include <algorithm>
 #include <fstream>
+#include <sstream>
 #include <numeric>
 #include <ranges>
 #include <iterator>
 #include <compare>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <utility>
+#include <bit>
+#include <memory>
+#include <functional>
+#include <charconv>
+#include <cmath>
+#include <ctime>
+
+// #define EULERISTIC_JSON_POSIX_IO before including this file, where POSIX is available, for write_to_file and write_to_file_parallel
+// to write through file descriptors: with scatter-gather writes, and with O_DIRECT and preallocation as write_options ask.
+// Otherwise they write through std::ofstream, and only the buffer_size and atomic options have an effect.
+#ifdef EULERISTIC_JSON_POSIX_IO
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cerrno>
+#endif //EULERISTIC_JSON_POSIX_IO
+
+// #define EULERISTIC_JSON_PARALLEL_WRITES before including this file for write_to_file_parallel, which renders values on several threads at once.
+#ifdef EULERISTIC_JSON_PARALLEL_WRITES
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <exception>
+#endif //EULERISTIC_JSON_PARALLEL_WRITES
 
 // #define EULERISTIC_JSON_COUT before including this file for run-time console output.
 #ifdef EULERISTIC_JSON_COUT
@@ -46,6 +77,53 @@
 #define PUSH_TO_COUT(values)
 #endif //EULERISTIC_JSON_COUT
 
+// #define EULERISTIC_JSON_ZLIB and/or EULERISTIC_JSON_ZSTD before including this file, and link zlib and/or zstd,
+// for parse_file and write_to_file to transparently handle .json.gz and/or .json.zst files.
+#if defined(EULERISTIC_JSON_ZLIB) || defined(EULERISTIC_JSON_ZSTD)
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <deque>
+#endif //EULERISTIC_JSON_ZLIB || EULERISTIC_JSON_ZSTD
+#ifdef EULERISTIC_JSON_ZLIB
+#include <zlib.h>
+#endif //EULERISTIC_JSON_ZLIB
+#ifdef EULERISTIC_JSON_ZSTD
+#include <zstd.h>
+#endif //EULERISTIC_JSON_ZSTD
+
+// #define EULERISTIC_JSON_COPY_ON_WRITE before including this file for copies of a value to share its arrays and objects until either is modified.
+
+// #define EULERISTIC_JSON_SERIALIZATION_CACHE before including this file for arrays and objects to keep their serialized text,
+// so that writing a value again only renders what has been modified since.
+#if defined(EULERISTIC_JSON_COPY_ON_WRITE) || defined(EULERISTIC_JSON_SERIALIZATION_CACHE)
+#include <atomic>
+#endif //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+#include <mutex>
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+
+// #define EULERISTIC_JSON_STATS before including this file for parsing to gather statistics, which json::statistics() returns.
+#ifdef EULERISTIC_JSON_STATS
+#include <chrono>
+#include <array>
+#define TIME_STATISTIC(duration) _statistics::_timer _statistics_timer(_statistics::_current.duration)
+#else //EULERISTIC_JSON_STATS
+#define TIME_STATISTIC(duration)
+#endif //EULERISTIC_JSON_STATS
+
+// #define EULERISTIC_JSON_ALLOCATION_HOOKS before including this file for json::allocation_counter, which counts the allocations of a thread,
+// and #define EULERISTIC_JSON_ALLOCATION_HOOKS_IMPLEMENTATION before including it in exactly one translation unit, which then replaces
+// the global operator new and operator delete with ones which report to it.
+#if defined(EULERISTIC_JSON_ALLOCATION_HOOKS_IMPLEMENTATION) && !defined(EULERISTIC_JSON_ALLOCATION_HOOKS)
+#define EULERISTIC_JSON_ALLOCATION_HOOKS
+#endif //EULERISTIC_JSON_ALLOCATION_HOOKS_IMPLEMENTATION && !EULERISTIC_JSON_ALLOCATION_HOOKS
+#ifdef EULERISTIC_JSON_ALLOCATION_HOOKS
+#include <new>
+#include <cstdlib>
+#endif //EULERISTIC_JSON_ALLOCATION_HOOKS
+
 // This JSON tool is written in accordance with ECMA-404, 2nd edition.
 // NOTE: THIS TOOL ASSUMES char IS UTF-8! If your system implements char differently, it should fail. 
 // If you write files with this software however, it can read it.
@@ -65,7 +143,8 @@ namespace euleristic::json {
 			INCORRECT_NUMBER_FORMAT,
 			STRING_TYPE_TOO_NARROW,
 			INTEGER_TYPE_TOO_NARROW,
-			FLOATING_POINT_TYPE_TOO_NARROW
+			FLOATING_POINT_TYPE_TOO_NARROW,
+			LIMIT_EXCEEDED
 		} type;
 		std::optional<uint16_t> line, character;
 	};
@@ -73,14 +152,49 @@ namespace euleristic::json {
 	// An enum representing an error during formatting.
 	enum class format_error {
 		ILLEGAL_CODE_POINT,
-		CONVERSION_FAILURE
+		CONVERSION_FAILURE,
+		FILE_WRITE_ERROR
 	};
 
 	enum class interface_misuse {
 		INCORRECT_TYPE,
 		INDEX_OUT_OF_RANGE,
 		NO_SUCH_KEY,
-		ILLEGAL_OPERAND
+		ILLEGAL_OPERAND,
+		TEST_FAILED
+	};
+
+	// Options for how write_to_file and write_to_file_parallel write to their file.
+	struct write_options {
+		// The number of bytes to fill before each write. Rounded up to a multiple of 4096.
+		size_t buffer_size = size_t(1) << 22;
+		// Whether to write to a temporary file beside the path, which replaces the file at the path once it is complete.
+		bool atomic = false;
+		// Whether to bypass the page cache (O_DIRECT) where supported.
+		bool direct = false;
+		// The size of the output if known in advance, in which case space for it is reserved up front.
+		std::optional<size_t> expected_size;
+	};
+
+	// Limits on what parse_text and parse_file may build, for untrusted sources. Each is checked as parsing goes,
+	// and the first one exceeded throws parsing_error LIMIT_EXCEEDED. Unset limits are not checked.
+	struct parse_options {
+		// The bytes the parse may hold at once: the tokens it makes along the way, and the value it builds, as value_type::memory_usage counts it.
+		std::optional<size_t> max_bytes;
+		// The longest a string or key may be once unescaped, in code units of string_type: bytes of UTF-8 for std::string.
+		std::optional<size_t> max_string_length;
+		// The most elements of an array or members of an object.
+		std::optional<size_t> max_container_size;
+		// The most values, counting the root and every element and member.
+		std::optional<size_t> max_nodes;
+		// The deepest nesting of arrays and objects.
+		std::optional<size_t> max_depth;
+	};
+
+	// Combines callables into one overload set, e.g. for value_type::visit: overloaded{ [](bool b) {...}, [](auto&&) {...} }.
+	template <typename... callables>
+	struct overloaded : callables... {
+		using callables::operator()...;
 	};
 
 	// Concepts
@@ -90,6 +204,279 @@ namespace euleristic::json {
 	template <std::integral I, std::floating_point F, string_concept S>
 	class value_type;
 
+	template <string_concept string_type = std::string>
+	class json_pointer;
+
+	template <string_concept string_type = std::string>
+	class json_path;
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	class json_patch;
+
+	template <string_concept string_type = std::string>
+	class projection;
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	class array_reader;
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	class document_stream;
+
+	template <string_concept string_type = std::string>
+	class stream_writer;
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	class hash_memo;
+
+	// Declarations of the interface functions, so that their default template arguments precede any friend declarations of them.
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_text(const std::string_view source);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_text(const std::string_view source, const projection<string_type>& selection);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_text(const std::string_view source, const parse_options& options);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_file(const std::filesystem::path path);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_file(const std::filesystem::path path, const parse_options& options);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	void write_to_file(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	void write_to_file(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path, const write_options& options);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_msgpack(const std::span<const uint8_t> source);
+
+#ifdef EULERISTIC_JSON_PARALLEL_WRITES
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	void write_to_file_parallel(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path, unsigned threads = 0);
+
+	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
+	void write_to_file_parallel(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path, const write_options& options, unsigned threads = 0);
+#endif //EULERISTIC_JSON_PARALLEL_WRITES
+
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] std::vector<uint8_t> to_msgpack(const value_type<integer_type, floating_point_type, string_type>& value);
+
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] std::string to_canonical(const value_type<integer_type, floating_point_type, string_type>& value);
+
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] size_t hash(const value_type<integer_type, floating_point_type, string_type>& value);
+
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void merge_patch(value_type<integer_type, floating_point_type, string_type>& target, const value_type<integer_type, floating_point_type, string_type>& patch);
+
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void merge_patch(value_type<integer_type, floating_point_type, string_type>& target, value_type<integer_type, floating_point_type, string_type>&& patch);
+
+#ifdef EULERISTIC_JSON_STATS
+	// Statistics of the parsing done on a thread.
+	struct parse_statistics {
+		// The bytes of JSON text which were tokenized.
+		size_t bytes = 0;
+		// The tokens, by type.
+		size_t bracket_tokens = 0;
+		size_t separator_tokens = 0;
+		size_t string_tokens = 0;
+		size_t number_tokens = 0;
+		size_t literal_tokens = 0;
+		// The deepest nesting of arrays and objects.
+		size_t max_depth = 0;
+		// The allocations held by the values parse_text and parse_file returned, and their size.
+		size_t allocations = 0;
+		size_t allocated_bytes = 0;
+		// The time spent tokenizing, parsing strings and keys, and converting numbers.
+		std::chrono::nanoseconds tokenize_time{};
+		std::chrono::nanoseconds string_time{};
+		std::chrono::nanoseconds number_time{};
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to.
+	// Gathers the parse statistics of the calling thread.
+	class _statistics {
+		static inline thread_local parse_statistics _current;
+		static inline thread_local size_t _depth = 0;
+
+		// Adds the time from its construction to its destruction to a duration.
+		class _timer {
+			std::chrono::nanoseconds& _duration;
+			const std::chrono::steady_clock::time_point _start = std::chrono::steady_clock::now();
+
+		public:
+			_timer(std::chrono::nanoseconds& duration) : _duration(duration) {}
+			~_timer() {
+				_duration += std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - _start);
+			}
+		};
+
+		static void _reset() {
+			_current = {};
+			_depth = 0;
+		}
+
+		// Friends
+		friend class _tokenizer;
+		friend class _string_handler;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class value_type;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_text(std::string_view);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_text(std::string_view, const parse_options&);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_file(std::filesystem::path, const parse_options&);
+		friend const parse_statistics& statistics();
+		friend void reset_statistics();
+	};
+
+	// The statistics of the parsing done on the calling thread since parse_text or parse_file last began, or since reset_statistics.
+	// Other ways of parsing, such as document_stream, add to them without resetting them.
+	[[nodiscard]] inline const parse_statistics& statistics() {
+		return _statistics::_current;
+	}
+
+	// Resets the statistics of the calling thread.
+	inline void reset_statistics() {
+		_statistics::_reset();
+	}
+#endif //EULERISTIC_JSON_STATS
+
+#ifdef EULERISTIC_JSON_ALLOCATION_HOOKS
+	// Counts the allocations made on the calling thread from its construction to its destruction, such as those of a parse or a write.
+	// Counters may be nested, in which case every one counts. If given a budget, an allocation which would bring the bytes allocated
+	// and not yet freed while counting past the budget throws std::bad_alloc instead. Counts nothing unless the global operators
+	// are replaced, by defining EULERISTIC_JSON_ALLOCATION_HOOKS_IMPLEMENTATION in one translation unit.
+	class allocation_counter {
+		static inline thread_local allocation_counter* _current = nullptr;
+
+		allocation_counter* _previous;
+		std::optional<size_t> _budget;
+		size_t _allocations = 0;
+		size_t _allocated_bytes = 0;
+		size_t _freed_bytes = 0;
+		size_t _peak_bytes = 0;
+
+		// The bytes allocated and not yet freed while counting, which is negative if more was freed than allocated.
+		long long _live_bytes() const {
+			return static_cast<long long>(_allocated_bytes) - static_cast<long long>(_freed_bytes);
+		}
+
+		// Counts an allocation of size bytes with every counter of the thread, or returns false if it would exceed a budget.
+		static bool _allocate(const size_t size) {
+			for (auto counter = _current; counter; counter = counter->_previous) {
+				if (counter->_budget && counter->_live_bytes() + static_cast<long long>(size) > static_cast<long long>(*counter->_budget)) {
+					return false;
+				}
+			}
+			for (auto counter = _current; counter; counter = counter->_previous) {
+				++counter->_allocations;
+				counter->_allocated_bytes += size;
+				counter->_peak_bytes = std::max(counter->_peak_bytes, static_cast<size_t>(std::max(0LL, counter->_live_bytes())));
+			}
+			return true;
+		}
+
+		// Counts the freeing of size bytes with every counter of the thread.
+		static void _free(const size_t size) {
+			for (auto counter = _current; counter; counter = counter->_previous) {
+				counter->_freed_bytes += size;
+			}
+		}
+
+		friend class _allocation_hooks;
+
+	public:
+		explicit allocation_counter(const std::optional<size_t> budget = {}) : _previous(_current), _budget(budget) {
+			_current = this;
+		}
+
+		~allocation_counter() {
+			_current = _previous;
+		}
+
+		allocation_counter(const allocation_counter&) = delete;
+		allocation_counter& operator=(const allocation_counter&) = delete;
+
+		// The number of allocations made while counting.
+		[[nodiscard]] size_t allocations() const {
+			return _allocations;
+		}
+
+		// The bytes allocated while counting.
+		[[nodiscard]] size_t allocated_bytes() const {
+			return _allocated_bytes;
+		}
+
+		// The bytes freed while counting, including those of allocations made before counting began.
+		[[nodiscard]] size_t freed_bytes() const {
+			return _freed_bytes;
+		}
+
+		// The most bytes allocated and not yet freed at once while counting.
+		[[nodiscard]] size_t peak_bytes() const {
+			return _peak_bytes;
+		}
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to.
+	// Allocates for the replaced global operators. Each allocation is preceded by a header which remembers its size,
+	// so that its freeing can be counted even when operator delete is not told the size.
+	class _allocation_hooks {
+		struct _header {
+			void* _block;
+			size_t _size;
+		};
+
+	public:
+		// Allocates size bytes aligned to alignment, or returns nullptr if out of memory or budget.
+		static void* _allocate(const size_t size, const size_t alignment) {
+			if (!allocation_counter::_allocate(size)) {
+				return nullptr;
+			}
+
+			// Room for the header, rounded up to the alignment, which malloc already gives up to that of max_align_t.
+			const size_t padding = alignment <= alignof(std::max_align_t) ? alignof(std::max_align_t) : alignment;
+			const size_t offset = (sizeof(_header) + padding - 1) / padding * padding;
+			void* block = std::malloc(size + offset + (alignment <= alignof(std::max_align_t) ? 0 : alignment));
+			if (!block) {
+				allocation_counter::_free(size);
+				return nullptr;
+			}
+			const auto address = (reinterpret_cast<uintptr_t>(block) + offset + padding - 1) / padding * padding;
+			auto memory = reinterpret_cast<void*>(address);
+			static_cast<_header*>(memory)[-1] = { block, size };
+			return memory;
+		}
+
+		static void _free(void* memory) {
+			if (!memory) {
+				return;
+			}
+			const auto header = static_cast<_header*>(memory)[-1];
+			allocation_counter::_free(header._size);
+			std::free(header._block);
+		}
+
+		// Allocates as operator new does, throwing std::bad_alloc on failure.
+		static void* _allocate_or_throw(const size_t size, const size_t alignment) {
+			if (void* memory = _allocate(size ? size : 1, alignment)) {
+				return memory;
+			}
+			throw std::bad_alloc{};
+		}
+	};
+#endif //EULERISTIC_JSON_ALLOCATION_HOOKS
+
 	// A class which hides implementation details so that the API is cleaner.
 	// Basically: DO NOT USE. Unless you really want to. 
 	class _tokenizer {
@@ -128,6 +515,70 @@ namespace euleristic::json {
 		// Transforms the JSON text source into a parsable JSON token sequence.
 		// If an unknown token is encountered, the unexpected value is returned, with the token's line and character number.
 		static std::vector<_token> _tokenize(const std::string_view source) {
+			std::vector<_token> token_sequence;
+			uint16_t line = 1;
+			uint16_t character = 1;
+			_tokenize(source, token_sequence, line, character, true);
+			return token_sequence;
+		}
+
+		// Appends the tokens of source to token_sequence, counting lines and characters on from line and character.
+		// Unless final, a token which may continue past the end of source is left unconsumed, so that source may be fed in chunks.
+		// Returns how many characters of source were consumed.
+		static size_t _tokenize(const std::string_view source, std::vector<_token>& token_sequence, uint16_t& line, uint16_t& character, const bool final) {
+#ifdef EULERISTIC_JSON_STATS
+			const size_t first = token_sequence.size();
+			size_t consumed;
+			{
+				TIME_STATISTIC(tokenize_time);
+				consumed = _tokenize_source(source, token_sequence, line, character, final);
+			}
+			_count(token_sequence, first, consumed);
+			return consumed;
+#else //EULERISTIC_JSON_STATS
+			return _tokenize_source(source, token_sequence, line, character, final);
+#endif //EULERISTIC_JSON_STATS
+		}
+
+#ifdef EULERISTIC_JSON_STATS
+		// Adds the tokens from first on, and the bytes they were tokenized from, to the statistics.
+		static void _count(const std::vector<_token>& token_sequence, const size_t first, const size_t bytes) {
+			auto& statistics = _statistics::_current;
+			statistics.bytes += bytes;
+			for (auto token = token_sequence.cbegin() + first; token != token_sequence.cend(); ++token) {
+				switch (token->_type) {
+				case _token::_type_t::LEFT_SQUARE_BRACKET:
+				case _token::_type_t::LEFT_CURLY_BRACKET:
+					++statistics.bracket_tokens;
+					statistics.max_depth = std::max(statistics.max_depth, ++_statistics::_depth);
+					break;
+				case _token::_type_t::RIGHT_SQUARE_BRACKET:
+				case _token::_type_t::RIGHT_CURLY_BRACKET:
+					++statistics.bracket_tokens;
+					if (_statistics::_depth != 0) {
+						--_statistics::_depth;
+					}
+					break;
+				case _token::_type_t::COLON:
+				case _token::_type_t::COMMA:
+					++statistics.separator_tokens;
+					break;
+				case _token::_type_t::STRING_LITERAL:
+					++statistics.string_tokens;
+					break;
+				case _token::_type_t::NUMBER_LITERAL:
+					++statistics.number_tokens;
+					break;
+				default:
+					++statistics.literal_tokens;
+					break;
+				}
+			}
+		}
+#endif //EULERISTIC_JSON_STATS
+
+		// Tokenizes as _tokenize does.
+		static size_t _tokenize_source(const std::string_view source, std::vector<_token>& token_sequence, uint16_t& line, uint16_t& character, const bool final) {
 
 			// A lambda which checks whether a UTF-8 code point is white space
 			auto is_white_space = [](const char c) -> bool {
@@ -146,11 +597,6 @@ namespace euleristic::json {
 					c == 'E' || c == '.' || c == '+';
 			};
 
-			std::vector<_token> token_sequence;
-
-			uint16_t line = 1;
-			uint16_t character = 1;
-
 			auto cursor = source.cbegin();
 
 			while (cursor < source.cend()) {
@@ -212,10 +658,13 @@ namespace euleristic::json {
 					// Literal name tokens
 
 				case 't':
+					if (!final && source.cend() - cursor <= 4) {
+						return static_cast<size_t>(cursor - source.cbegin());
+					}
 					if (source.cend() - cursor < 4) {
 						throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, line, character };
 					}
-					else if (!is_token_delimiter(*(cursor + 4))) {
+					else if (cursor + 4 != source.cend() && !is_token_delimiter(*(cursor + 4))) {
 						throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, line, character };
 					}
 					if (std::string_view(cursor, cursor + 4) != "true") {
@@ -227,10 +676,13 @@ namespace euleristic::json {
 					continue;
 
 				case 'f':
+					if (!final && source.cend() - cursor <= 5) {
+						return static_cast<size_t>(cursor - source.cbegin());
+					}
 					if (source.cend() - cursor < 5) {
 						throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, line, character };
 					}
-					else if (!is_token_delimiter(*(cursor + 5))) {
+					else if (cursor + 5 != source.cend() && !is_token_delimiter(*(cursor + 5))) {
 						throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, line, character };
 					}
 					if (std::string_view(cursor, cursor + 5) != "false") {
@@ -242,10 +694,13 @@ namespace euleristic::json {
 					continue;
 
 				case 'n':
+					if (!final && source.cend() - cursor <= 4) {
+						return static_cast<size_t>(cursor - source.cbegin());
+					}
 					if (source.cend() - cursor < 4) {
 						throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, line, character };
 					}
-					else if (!is_token_delimiter(*(cursor + 4))) {
+					else if (cursor + 4 != source.cend() && !is_token_delimiter(*(cursor + 4))) {
 						throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, line, character };
 					}
 					if (std::string_view(cursor, cursor + 4) != "null") {
@@ -264,17 +719,20 @@ namespace euleristic::json {
 					// The tokenizer will not ensure the validity of the string, only that it has a valid start and end.
 
 					auto peeker = cursor + 1;
-					while (*peeker != '\"') {
+					while (peeker != source.cend() && *peeker != '\"') {
 						if (*peeker == '\\') {
 							++peeker;
 							if (peeker == source.cend()) {
-								throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, line, character };
+								break;
 							}
 						}
 						++peeker;
-						if (peeker == source.cend()) {
-							throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, line, character };
+					}
+					if (peeker == source.cend()) {
+						if (!final) {
+							return static_cast<size_t>(cursor - source.cbegin());
 						}
+						throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, line, character };
 					}
 					token_sequence.push_back({ _token::_type_t::STRING_LITERAL, line, character, std::string(cursor + 1, peeker) });
 					character += 1 + static_cast<uint16_t>(peeker - cursor);
@@ -289,6 +747,9 @@ namespace euleristic::json {
 					while (peeker != source.cend() && is_number_character(*peeker)) {
 						++peeker;
 					}
+					if (!final && peeker == source.cend()) {
+						return static_cast<size_t>(cursor - source.cbegin());
+					}
 					token_sequence.push_back({ _token::_type_t::NUMBER_LITERAL, line, character, std::string(cursor, peeker) });
 					character += static_cast<uint16_t>(peeker - cursor);
 					cursor = peeker;
@@ -299,7 +760,7 @@ namespace euleristic::json {
 					throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, line, character };
 				}
 			}
-			return token_sequence;
+			return static_cast<size_t>(cursor - source.cbegin());
 		}
 
 		// Friends
@@ -307,6 +768,125 @@ namespace euleristic::json {
 		friend class value_type;
 		template <std::integral I, std::floating_point F, string_concept S>
 		friend value_type<I, F, S> parse_text(const std::string_view);
+		friend class _compression;
+		friend class _token_stream;
+		template <string_concept S>
+		friend class projection;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class array_reader;
+		friend class _limiter;
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to.
+	// Enforces the limits of parse_options on one parse, as the tokens and then the value are made.
+	class _limiter {
+		static constexpr size_t _chunk_size = size_t(1) << 20;
+
+		const parse_options& _options;
+		size_t _bytes = 0;
+		size_t _nodes = 0;
+		size_t _depth = 0;
+
+		_limiter(const parse_options& options) : _options(options) {}
+
+		// Whether any limit is set, or else parsing need not go through a _limiter.
+		static bool _limits(const parse_options& options) {
+			return options.max_bytes || options.max_string_length || options.max_container_size || options.max_nodes || options.max_depth;
+		}
+
+		static void _check(const std::optional<size_t>& limit, const size_t value, [[maybe_unused]] const char* name, const _tokenizer::_token& token) {
+			if (limit && value > *limit) {
+				PUSH_TO_COUT("Token at (" << token._line << ", " << token._character << ") exceeded the " << name << " limit of " << *limit << ".\n");
+				throw parsing_error{ parsing_error::type_t::LIMIT_EXCEEDED, token._line, token._character };
+			}
+		}
+
+		void _add_bytes(const size_t bytes, const _tokenizer::_token& token) {
+			_bytes += bytes;
+			_check(_options.max_bytes, _bytes, "max_bytes", token);
+		}
+
+		// Counts the tokens from first on, which are held until the parse is done, and follows their nesting.
+		void _tokens(const std::vector<_tokenizer::_token>& token_sequence, const size_t first) {
+			for (auto token = token_sequence.cbegin() + first; token != token_sequence.cend(); ++token) {
+				switch (token->_type) {
+				case _tokenizer::_token::_type_t::LEFT_SQUARE_BRACKET:
+				case _tokenizer::_token::_type_t::LEFT_CURLY_BRACKET:
+					_check(_options.max_depth, ++_depth, "max_depth", *token);
+					break;
+				case _tokenizer::_token::_type_t::RIGHT_SQUARE_BRACKET:
+				case _tokenizer::_token::_type_t::RIGHT_CURLY_BRACKET:
+					if (_depth != 0) {
+						--_depth;
+					}
+					break;
+				default:
+					break;
+				}
+				const size_t text = token->_value && token->_value->capacity() > std::string{}.capacity() ? token->_value->capacity() + 1 : 0;
+				_add_bytes(sizeof(_tokenizer::_token) + text, *token);
+			}
+		}
+
+		// Tokenizes source a chunk at a time, so that a limit is exceeded before the whole source has been tokenized.
+		std::vector<_tokenizer::_token> _tokenize(const std::string_view source) {
+			std::vector<_tokenizer::_token> token_sequence;
+			uint16_t line = 1;
+			uint16_t character = 1;
+			size_t offset = 0;
+			size_t window = _chunk_size;
+			while (offset < source.size()) {
+				const size_t first = token_sequence.size();
+				const size_t size = std::min(window, source.size() - offset);
+				const size_t consumed = _tokenizer::_tokenize(source.substr(offset, size), token_sequence, line, character, offset + size == source.size());
+				_tokens(token_sequence, first);
+
+				// A token longer than the window needs a wider window.
+				window = consumed == 0 ? window * 2 : _chunk_size;
+				offset += consumed;
+			}
+			return token_sequence;
+		}
+
+		// Counts held bytes of text which are held back, at line and character, until the literal they begin is finished by later text,
+		// of which literal is known to belong to the literal. They are only held until then, so they are not added to the count,
+		// but a literal which never ends must not hold all of the source.
+		void _pending(const std::string_view literal, const size_t held, const uint16_t line, const uint16_t character) const {
+			const bool string = !literal.empty() && literal.front() == '"';
+			const _tokenizer::_token token{ string ? _tokenizer::_token::_type_t::STRING_LITERAL : _tokenizer::_token::_type_t::NUMBER_LITERAL, line, character, {} };
+			_check(_options.max_bytes, _bytes + held, "max_bytes", token);
+			if (string) {
+				// A code unit takes at most six bytes of text, as an escape, so the string is at least this long once unescaped.
+				_check(_options.max_string_length, (literal.size() - 1) / 6, "max_string_length", token);
+			}
+		}
+
+		// Counts a value of size bytes, which begins at token.
+		void _node(const size_t size, const _tokenizer::_token& token) {
+			_check(_options.max_nodes, ++_nodes, "max_nodes", token);
+			_add_bytes(size, token);
+		}
+
+		// Counts a string or key of length code units, which allocated bytes.
+		void _string(const size_t length, const size_t bytes, const _tokenizer::_token& token) {
+			_check(_options.max_string_length, length, "max_string_length", token);
+			_add_bytes(bytes, token);
+		}
+
+		// Counts an array or object which has grown to size elements or members.
+		void _container(const size_t size, const _tokenizer::_token& token) {
+			_check(_options.max_container_size, size, "max_container_size", token);
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class value_type;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_text(std::string_view, const parse_options&);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_file(std::filesystem::path, const parse_options&);
+		friend class _compression;
 	};
 
 	// A class which hides implementation details so that the API is cleaner.
@@ -325,17 +905,88 @@ namespace euleristic::json {
 		template <string_concept string_type>
 		static std::string _format_string(const std::basic_string_view<typename string_type::value_type> input);
 
+		// Formats the integer as JSON.
+		template <std::integral integer_type>
+		static std::string _format_integer(const integer_type value) {
+			if constexpr (!std::is_same_v<integer_type, int>
+				|| !std::is_same_v<integer_type, long>
+				|| !std::is_same_v<integer_type, long long>
+				|| !std::is_same_v<integer_type, unsigned int>
+				|| !std::is_same_v<integer_type, unsigned long>
+				|| !std::is_same_v<integer_type, unsigned long long>)
+				return std::to_string(value);
+			else
+				return std::to_string(static_cast<long long>(value));
+		}
+
+		// Formats the floating point number as JSON.
+		template <std::floating_point floating_point_type>
+		static std::string _format_floating_point(const floating_point_type value) {
+			return std::to_string(value);
+		}
+
+		// Converts UTF-8 to string_type, without any JSON unescaping.
+		template <string_concept string_type>
+		static string_type _widen(const std::string_view input) {
+			if constexpr (std::is_same_v<string_type, std::string>) {
+				return string_type(input);
+			}
+			else {
+				std::wstring output(input.size(), L'\0');
+				const char* cursor = input.data();
+				wchar_t* wcursor = output.data();
+				mbstate_t mbstate{};
+				auto result = _code_conv_facet.in(mbstate, input.data(), input.data() + input.size(), cursor,
+					output.data(), output.data() + output.size(), wcursor);
+				if (result != std::codecvt_base::ok && result != std::codecvt_base::noconv) {
+					throw parsing_error{ parsing_error::type_t::ILLEGAL_CODE_POINT, {}, {} };
+				}
+				output.resize(wcursor - output.data());
+				return output;
+			}
+		}
+
+		// Converts string_type to UTF-8, without any JSON escaping.
+		template <string_concept string_type>
+		static std::string _narrow(const std::basic_string_view<typename string_type::value_type> input) {
+			if constexpr (std::is_same_v<string_type, std::string>) {
+				return std::string(input);
+			}
+			else {
+				std::string output(input.size() * _code_conv_facet.max_length(), '\0');
+				const wchar_t* wcursor = input.data();
+				char* cursor = output.data();
+				mbstate_t mbstate{};
+				auto result = _code_conv_facet.out(mbstate, input.data(), input.data() + input.size(), wcursor,
+					output.data(), output.data() + output.size(), cursor);
+				if (result == std::codecvt_base::error) {
+					throw format_error::ILLEGAL_CODE_POINT;
+				}
+				if (result != std::codecvt_base::ok && result != std::codecvt_base::noconv) {
+					throw format_error::CONVERSION_FAILURE;
+				}
+				output.resize(cursor - output.data());
+				return output;
+			}
+		}
+
 		// Friends
 		template <std::integral I, std::floating_point F, string_concept S> friend class value_type;
+		friend class _msgpack;
+		template <string_concept S> friend class projection;
+		template <string_concept S> friend class stream_writer;
+		friend class _parallel_writer;
+		friend class _canonical;
 
 	};
 
 	// Parses the string and converts it to wide.
 	template <>
 	std::wstring _string_handler::_parse_string(const std::string_view input, const uint16_t line, const uint16_t character) {
+		TIME_STATISTIC(string_time);
 
 		// Check for control characters
-		auto ctrl_char = std::find_if(input.cbegin(), input.cend(), [](const char c) { return c <= 0x1F; });
+		auto ctrl_char = std::find_if(input.cbegin(), input.cend(), [](const char c) { return static_cast<unsigned char>(c) <= 0x1F; });
 		if (ctrl_char != input.cend()) {
 			throw parsing_error{ parsing_error::type_t::ILLEGAL_CODE_POINT, line, character + static_cast<uint16_t>(ctrl_char - input.cbegin()) };
 		}
@@ -417,11 +1068,12 @@ namespace euleristic::json {
 	// Parses the string without conversion.
 	template <>
 	std::string _string_handler::_parse_string<std::string>(const std::string_view input, const uint16_t line, const uint16_t character) {
+		TIME_STATISTIC(string_time);
 		std::string output;
 		for (auto it = input.cbegin(); it != input.cend(); ++it) {
 
 			// Control characters are not allowed
-			if (*it <= 0x1F) {
+			if (static_cast<unsigned char>(*it) <= 0x1F) {
 				throw parsing_error{ parsing_error::type_t::ILLEGAL_CODE_POINT, line, character + static_cast<uint16_t>(it - input.cbegin()) };
 			}
 
@@ -595,12 +1247,65 @@ namespace euleristic::json {
 			if (c == '\n') return str + "\\n";
 			if (c == '\r') return str + "\\r";
 			if (c == '\t') return str + "\\t";
-			if (c <= 0x1F) throw format_error::ILLEGAL_CODE_POINT;
+			if (static_cast<unsigned char>(c) <= 0x1F) throw format_error::ILLEGAL_CODE_POINT;
 			return str + c;
 		});
 	}
 
 
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to.
+	// Passes what is written through it on to a stream, while recording it into a serialization cache, unless it grows past the limit.
+	// While it lives, it is the active recorder of its thread, so that containers written within it know that their text is already
+	// recorded, and only the outermost container records each byte.
+	class _cache_recorder : public std::streambuf {
+
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class value_type;
+
+		static inline thread_local _cache_recorder* _active = nullptr;
+
+		std::ostream& _stream;
+		std::string& _text;
+		size_t _limit;
+		bool _overflowed = false;
+		_cache_recorder* _outer;
+
+		_cache_recorder(std::ostream& stream, std::string& text, size_t limit) : _stream(stream), _text(text), _limit(limit), _outer(_active) {
+			_active = this;
+		}
+
+		~_cache_recorder() {
+			_active = _outer;
+		}
+
+		_cache_recorder(const _cache_recorder&) = delete;
+		_cache_recorder& operator=(const _cache_recorder&) = delete;
+
+		std::streamsize xsputn(const char* characters, std::streamsize count) override {
+			if (!_overflowed) {
+				if (_text.size() + static_cast<size_t>(count) > _limit) {
+					_overflowed = true;
+					std::string{}.swap(_text);
+				}
+				else {
+					_text.append(characters, static_cast<size_t>(count));
+				}
+			}
+			_stream.write(characters, count);
+			return count;
+		}
+
+		int_type overflow(int_type character) override {
+			if (traits_type::eq_int_type(character, traits_type::eof())) return traits_type::not_eof(character);
+			char c = traits_type::to_char_type(character);
+			xsputn(&c, 1);
+			return character;
+		}
+	};
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+
 	// Wraps a JSON value and provides an interface for access and modification of it, given the user provided C++ types. If null, the json_value is not set.
 	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
 	class value_type {
@@ -609,7 +1314,59 @@ namespace euleristic::json {
 
 		using _object_alias = std::unordered_map<string_type, value_type<integer_type, floating_point_type, string_type>>;
 		using _array_alias = std::vector<value_type>;
-		using _value_alias = std::optional<std::variant<_object_alias, _array_alias, integer_type, floating_point_type, string_type, bool>>;
+
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+		// The text of a container, as written at indentation level _depth. Containers whose text is longer than _limit are not cached,
+		// but their elements may be. Writing is const, and values which share a container may be written on separate threads at once,
+		// so the cache is only read or replaced under _mutex, and text is never modified once cached, only replaced.
+		struct _cache_t {
+			static constexpr size_t _limit = 1 << 16;
+			std::mutex _mutex;
+			std::shared_ptr<const std::string> _text;
+			size_t _depth = 0;
+			bool _too_large = false;
+
+			void _clear() {
+				std::lock_guard lock(_mutex);
+				_text.reset();
+				_too_large = false;
+			}
+		};
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+
+		// An array or object, along with its cached text if the cache is enabled.
+		template <typename container_type>
+		struct _node {
+			container_type _elements;
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+			mutable _cache_t _cache{};
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+#if defined(EULERISTIC_JSON_COPY_ON_WRITE) || defined(EULERISTIC_JSON_SERIALIZATION_CACHE)
+			// Whether a reference mutable_at has handed out to an element may still be written through. Set by mutable_at, on a container
+			// which is not shared, and cleared when such references end: as the container is next modified by other means, and with
+			// EULERISTIC_JSON_COPY_ON_WRITE as a value holding it is copied. Atomic, since separate threads may copy it at once.
+			// Without either macro, arrays and objects are only held through nodes as deduplicate shares them, and need no such mark.
+			std::atomic<bool> _exposed{ false };
+#endif //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
+
+			_node(const container_type& elements) : _elements(elements) {}
+			_node(container_type&& elements) : _elements(std::move(elements)) {}
+		};
+
+		using _array_node = _node<_array_alias>;
+		using _object_node = _node<_object_alias>;
+
+		// Arrays and objects are held through shared pointers where they may be shared: between copies with EULERISTIC_JSON_COPY_ON_WRITE,
+		// and within a value by deduplicate. Shared ones are only copied once a value which shares them modifies them. The cached text is
+		// kept in the node too, so with either macro, every array and object is held through one. Otherwise they are held within the value,
+		// and only moved into a node as deduplicate shares them, so that copies, which are deep, neither allocate nor reach through nodes.
+#if defined(EULERISTIC_JSON_COPY_ON_WRITE) || defined(EULERISTIC_JSON_SERIALIZATION_CACHE)
+		static constexpr bool _held_within = false;
+		using _value_alias = std::optional<std::variant<std::shared_ptr<_object_node>, std::shared_ptr<_array_node>, integer_type, floating_point_type, string_type, bool>>;
+#else //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
+		static constexpr bool _held_within = true;
+		using _value_alias = std::optional<std::variant<std::shared_ptr<_object_node>, std::shared_ptr<_array_node>, integer_type, floating_point_type, string_type, bool, _object_alias, _array_alias>>;
+#endif //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
 
 		// Underlying value.
 		_value_alias _value;
@@ -623,30 +1380,350 @@ namespace euleristic::json {
 		template <std::integral I, std::floating_point F, string_concept S>
 		friend value_type<I, F, S> parse_text(std::string_view);
 		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_text(std::string_view, const parse_options&);
+		template <std::integral I, std::floating_point F, string_concept S>
 		friend std::ostream& operator<<(std::ostream&, const value_type<I, F, S>&);
 		template <std::integral I, std::floating_point F, string_concept S>
 		friend std::partial_ordering operator<=>(const value_type<I, F, S>& lhs, const value_type<I, F, S>& rhs);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend bool operator==(const value_type<I, F, S>& lhs, const value_type<I, F, S>& rhs);
+		friend class _merger;
+		friend class _msgpack;
+		friend class _compression;
+		template <string_concept S>
+		friend class json_pointer;
+		template <string_concept S>
+		friend class json_path;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class json_patch;
+		template <string_concept S>
+		friend class projection;
+		friend class _token_stream;
+		friend class _parallel_writer;
+		friend class _canonical;
+		friend class _hasher;
+		friend class _deduplicator;
+		friend class _numeric_equality;
+		template <string_concept S>
+		friend class stream_writer;
+
+		// Holds array.
+		void _hold(_array_alias&& array) {
+			_type = _type_t::ARRAY;
+			if constexpr (_held_within) {
+				_value.emplace(std::in_place_type<_array_alias>, std::move(array));
+			}
+			else {
+				_value = std::make_shared<_array_node>(std::move(array));
+			}
+		}
 
-		// Writes the value to the stream in JSON at indentation level depth.
-		void _write_to_ostream(std::ostream& stream, size_t depth = 0) const {
-			auto indent = [&stream](size_t depth) {
-				for (size_t i = 0; i < depth; ++i) stream << '\t';
-			};
+		// Holds object.
+		void _hold(_object_alias&& object) {
+			_type = _type_t::OBJECT;
+			if constexpr (_held_within) {
+				_value.emplace(std::in_place_type<_object_alias>, std::move(object));
+			}
+			else {
+				_value = std::make_shared<_object_node>(std::move(object));
+			}
+		}
 
-			switch (_type) {
-			case _type_t::ARRAY: {
+		// The held array, which must be held.
+		const _array_alias& _array() const {
+			if constexpr (_held_within) {
+				if (auto array = std::get_if<_array_alias>(&*_value)) {
+					return *array;
+				}
+			}
+			return std::get<std::shared_ptr<_array_node>>(*_value)->_elements;
+		}
 
-				auto& arr = std::get<_array_alias>(*_value);
-				stream << '[';
-				if (arr.empty()) {
-					stream << ']';
-					return;
+		// The held object, which must be held.
+		const _object_alias& _object() const {
+			if constexpr (_held_within) {
+				if (auto object = std::get_if<_object_alias>(&*_value)) {
+					return *object;
 				}
-				else {
-					stream << '\n';
-					for (auto it = arr.begin(); it != arr.end(); ++it) {
+			}
+			return std::get<std::shared_ptr<_object_node>>(*_value)->_elements;
+		}
+
+		// The held array, which must be held, for modification. If it is shared, this first gets a copy of its own,
+		// which shares the elements of the original until they too are modified. This ends the references mutable_at has handed out
+		// into the array, which mutable_at then marks again if it is what called this.
+		// This drops the cached text of the array. Since elements are only reached for modification through this and _mutable_object,
+		// every container above a modification has had its text dropped too, unless the modification is made through a reference
+		// from mutable_at, whose containers are not cached while the reference may be written through.
+		_array_alias& _mutable_array() {
+			if constexpr (_held_within) {
+				// An array deduplicate has shared is taken back within this, and only copied if it is still shared.
+				if (auto shared = std::get_if<std::shared_ptr<_array_node>>(&*_value)) {
+					auto node = std::move(*shared);
+					if (node.use_count() == 1) {
+						_value.emplace(std::in_place_type<_array_alias>, std::move(node->_elements));
+					}
+					else {
+						_value.emplace(std::in_place_type<_array_alias>, node->_elements);
+					}
+				}
+				return std::get<_array_alias>(*_value);
+			}
+			auto& array = std::get<std::shared_ptr<_array_node>>(*_value);
+			if (array.use_count() != 1) {
+				array = std::make_shared<_array_node>(array->_elements);
+			}
+#if defined(EULERISTIC_JSON_COPY_ON_WRITE) || defined(EULERISTIC_JSON_SERIALIZATION_CACHE)
+			else {
+				// The count is read without ordering, so what copies on other threads did with the array before they let go of it is ordered before this.
+				std::atomic_thread_fence(std::memory_order_acquire);
+				array->_exposed.store(false, std::memory_order_relaxed);
+			}
+#endif //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+			array->_cache._clear();
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+			return array->_elements;
+		}
+
+		// The held object, which must be held, for modification. If it is shared, this first gets a copy of its own,
+		// which shares the members of the original until they too are modified.
+		_object_alias& _mutable_object() {
+			if constexpr (_held_within) {
+				if (auto shared = std::get_if<std::shared_ptr<_object_node>>(&*_value)) {
+					auto node = std::move(*shared);
+					if (node.use_count() == 1) {
+						_value.emplace(std::in_place_type<_object_alias>, std::move(node->_elements));
+					}
+					else {
+						_value.emplace(std::in_place_type<_object_alias>, node->_elements);
+					}
+				}
+				return std::get<_object_alias>(*_value);
+			}
+			auto& object = std::get<std::shared_ptr<_object_node>>(*_value);
+			if (object.use_count() != 1) {
+				object = std::make_shared<_object_node>(object->_elements);
+			}
+#if defined(EULERISTIC_JSON_COPY_ON_WRITE) || defined(EULERISTIC_JSON_SERIALIZATION_CACHE)
+			else {
+				std::atomic_thread_fence(std::memory_order_acquire);
+				object->_exposed.store(false, std::memory_order_relaxed);
+			}
+#endif //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+			object->_cache._clear();
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+			return object->_elements;
+		}
+
+		// Called by the copy constructor for an array or object which other holds through node, to hold a copy of its own, built straight
+		// from the elements, whose own copy constructors copy them the same way. With EULERISTIC_JSON_COPY_ON_WRITE, this shares node
+		// instead, which ends the references mutable_at has handed out into it, since what is written through them would show in both.
+		template <typename container_type>
+		void _copy(const std::shared_ptr<_node<container_type>>& node) {
+#ifdef EULERISTIC_JSON_COPY_ON_WRITE
+			if (node->_exposed.load(std::memory_order_relaxed)) {
+				node->_exposed.store(false, std::memory_order_relaxed);
+			}
+			_value = node;
+#else //EULERISTIC_JSON_COPY_ON_WRITE
+			if constexpr (_held_within) {
+				_value.emplace(std::in_place_type<container_type>, node->_elements);
+			}
+			else {
+				_value = std::make_shared<_node<container_type>>(node->_elements);
+			}
+#endif //EULERISTIC_JSON_COPY_ON_WRITE
+		}
+
+		// Shares the array or object of other, if it holds one, whether or not copies share them. If other holds it within itself,
+		// it is first moved into a node, which leaves the elements where they are.
+		void _share(value_type& other) {
+			if constexpr (_held_within) {
+				if (auto array = std::get_if<_array_alias>(&*other._value)) {
+					other._value = std::make_shared<_array_node>(std::move(*array));
+				}
+				else if (auto object = std::get_if<_object_alias>(&*other._value)) {
+					other._value = std::make_shared<_object_node>(std::move(*object));
+				}
+			}
+			_value = other._value;
+			_type = other._type;
+		}
+
+		// Whether the held array or object, which must be held, is shared, so that _mutable_array or _mutable_object would copy it.
+		bool _shared() const {
+			if (auto array = std::get_if<std::shared_ptr<_array_node>>(&*_value)) {
+				return array->use_count() != 1;
+			}
+			if (auto object = std::get_if<std::shared_ptr<_object_node>>(&*_value)) {
+				return object->use_count() != 1;
+			}
+			return false;
+		}
+
+		// The bytes string has allocated, if it is too long to be held within itself.
+		static size_t _heap_bytes(const string_type& string) {
+			return string.capacity() > string_type{}.capacity() ? (string.capacity() + 1) * sizeof(typename string_type::value_type) : 0;
+		}
+
+		// Adds the allocations held by the value, and their size, to allocations and bytes: those of its string, or of its array or object
+		// and everything in it. If seen is given, arrays and objects which are shared are only counted the first time they are seen.
+		// If owned, arrays and objects which are shared with other values are not counted at all, so that what is counted is what
+		// destroying the value would free.
+		// Sizes are as laid out by libstdc++: make_shared puts its counts beside the node, and every member of an unordered_map
+		// is a node of its own, linked to the next and remembering the hash of its key. Other standard libraries differ slightly.
+		// The text cached by the serialization cache, if it is enabled, is counted with its container.
+		void _account(size_t& allocations, size_t& bytes, std::unordered_set<const void*>* seen, const bool owned = false) const {
+			constexpr size_t control_block = 2 * sizeof(void*);
+			auto account_string = [&](const string_type& string) {
+				if (const size_t heap = _heap_bytes(string)) {
+					++allocations;
+					bytes += heap;
+				}
+			};
+			auto account_cache = [&]([[maybe_unused]] const auto& node) {
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+				std::lock_guard lock(node._cache._mutex);
+				if (node._cache._text) {
+					++allocations;
+					bytes += sizeof(std::string) + control_block;
+					if (node._cache._text->capacity() > std::string{}.capacity()) {
+						++allocations;
+						bytes += node._cache._text->capacity() + 1;
+					}
+				}
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+			};
+
+			switch (_type) {
+			case _type_t::ARRAY: {
+				if (auto shared = std::get_if<std::shared_ptr<_array_node>>(&*_value)) {
+					if ((owned && shared->use_count() != 1) || (seen && !seen->insert(shared->get()).second)) {
+						return;
+					}
+					++allocations;
+					bytes += sizeof(**shared) + control_block;
+					account_cache(**shared);
+				}
+				auto& array = _array();
+				if (array.capacity() != 0) {
+					++allocations;
+					bytes += array.capacity() * sizeof(value_type);
+				}
+				for (auto& element : array) {
+					element._account(allocations, bytes, seen, owned);
+				}
+				return;
+			}
+			case _type_t::OBJECT: {
+				if (auto shared = std::get_if<std::shared_ptr<_object_node>>(&*_value)) {
+					if ((owned && shared->use_count() != 1) || (seen && !seen->insert(shared->get()).second)) {
+						return;
+					}
+					++allocations;
+					bytes += sizeof(**shared) + control_block;
+					account_cache(**shared);
+				}
+				auto& object = _object();
+
+				// A table of a single bucket is held within the unordered_map itself.
+				if (object.bucket_count() > 1) {
+					++allocations;
+					bytes += object.bucket_count() * sizeof(void*);
+				}
+				allocations += object.size();
+				bytes += object.size() * (sizeof(void*) + sizeof(typename _object_alias::value_type) + sizeof(size_t));
+				for (auto& [key, element] : object) {
+					account_string(key);
+					element._account(allocations, bytes, seen, owned);
+				}
+				return;
+			}
+			case _type_t::STRING:
+				account_string(std::get<string_type>(*_value));
+				return;
+			default:
+				return;
+			}
+		}
+
+		// Writes the value to the stream in JSON at indentation level depth. If cached, arrays and objects
+		// whose text is cached at that level are copied from it, and others are cached as they are written, unless a container
+		// around them is already recording its text, which includes theirs. Arrays and objects with references from mutable_at
+		// into them which may still be written through are neither, since what is written through those does not drop their text.
+		void _write_to_ostream(std::ostream& stream, size_t depth = 0, bool cached = true) const {
+#ifdef EULERISTIC_JSON_SERIALIZATION_CACHE
+			if (cached && (_type == _type_t::ARRAY || _type == _type_t::OBJECT)) {
+				auto& cache = _type == _type_t::ARRAY ? std::get<std::shared_ptr<_array_node>>(*_value)->_cache : std::get<std::shared_ptr<_object_node>>(*_value)->_cache;
+				const bool exposed = (_type == _type_t::ARRAY ? std::get<std::shared_ptr<_array_node>>(*_value)->_exposed : std::get<std::shared_ptr<_object_node>>(*_value)->_exposed).load(std::memory_order_relaxed);
+
+				// A recorder which has given up only passes its text on, so write past it.
+				auto outer = _cache_recorder::_active;
+				auto& destination = outer && outer->_overflowed ? outer->_stream : stream;
+
+				std::shared_ptr<const std::string> text;
+				bool too_large = false;
+				{
+					std::lock_guard lock(cache._mutex);
+					if (cache._text && cache._depth == depth) {
+						text = cache._text;
+					}
+					too_large = cache._too_large;
+				}
+				if (text && !exposed) {
+					destination.write(text->data(), static_cast<std::streamsize>(text->size()));
+					return;
+				}
+				if (exposed || too_large || (outer && !outer->_overflowed)) {
+					_render(destination, depth, cached);
+					return;
+				}
+
+				std::string recorded;
+				bool overflowed = false;
+				{
+					_cache_recorder recorder(destination, recorded, _cache_t::_limit);
+					std::ostream recording(&recorder);
+					_render(recording, depth, cached);
+					overflowed = recorder._overflowed;
+				}
+				std::lock_guard lock(cache._mutex);
+				if (overflowed) {
+					cache._text.reset();
+					cache._too_large = true;
+				}
+				else {
+					cache._text = std::make_shared<const std::string>(std::move(recorded));
+					cache._depth = depth;
+				}
+				return;
+			}
+#endif //EULERISTIC_JSON_SERIALIZATION_CACHE
+			_render(stream, depth, cached);
+		}
+
+		// Renders the value to the stream in JSON at indentation level depth, writing its elements through _write_to_ostream.
+		void _render(std::ostream& stream, size_t depth, bool cached) const {
+			auto indent = [&stream](size_t depth) {
+				for (size_t i = 0; i < depth; ++i) stream << '\t';
+			};
+
+			switch (_type) {
+			case _type_t::ARRAY: {
+
+				auto& arr = _array();
+				stream << '[';
+				if (arr.empty()) {
+					stream << ']';
+					return;
+				}
+				else {
+					stream << '\n';
+					for (auto it = arr.begin(); it != arr.end(); ++it) {
 						indent(depth + 1);
-						it->_write_to_ostream(stream, depth + 1);
+						it->_write_to_ostream(stream, depth + 1, cached);
 						if (std::next(it) != arr.end()) {
 							stream << ",\n";
 						}
@@ -659,7 +1736,7 @@ namespace euleristic::json {
 			}
 
 			case _type_t::OBJECT: {
-				auto& obj = std::get<_object_alias>(*_value);
+				auto& obj = _object();
 				stream << '{';
 				if (obj.empty()) {
 					stream << '}';
@@ -671,7 +1748,7 @@ namespace euleristic::json {
 						indent(depth + 1); // i love u baby. u are my wife.
 						auto& [key, value] = *it;
 						stream << '\"' << _string_handler::_format_string<string_type>(key) << "\": ";
-						value._write_to_ostream(stream, depth + 1);
+						value._write_to_ostream(stream, depth + 1, cached);
 						if (std::next(it) != obj.end()) {
 							stream << ",\n";
 						}
@@ -688,18 +1765,10 @@ namespace euleristic::json {
 				return;
 			}
 			case _type_t::INTEGER:
-				if constexpr (!std::is_same_v<integer_type, int>
-					|| !std::is_same_v<integer_type, long>
-					|| !std::is_same_v<integer_type, long long>
-					|| !std::is_same_v<integer_type, unsigned int>
-					|| !std::is_same_v<integer_type, unsigned long>
-					|| !std::is_same_v<integer_type, unsigned long long>)
-					stream << std::to_string(std::get<integer_type>(*_value));
-				else
-					stream << std::to_string(static_cast<long long>(std::get<integer_type>(*_value)));
+				stream << _string_handler::_format_integer(std::get<integer_type>(*_value));
 				return;
 			case _type_t::FLOATING_POINT:
-				stream << std::to_string(std::get<floating_point_type>(*_value));
+				stream << _string_handler::_format_floating_point(std::get<floating_point_type>(*_value));
 				return;
 			case _type_t::BOOLEAN:
 				if (std::get<bool>(*_value))
@@ -718,27 +1787,38 @@ namespace euleristic::json {
 
 		// Parses the value beginning at cursor and ending some time before end.
 		// Cursor should after returning be one element past the value (e.g. past ] or }).
-		value_type(std::vector<_tokenizer::_token>::const_iterator& cursor, const std::vector<_tokenizer::_token>::const_iterator end) {
+		// If limits are given, every value, element, member and string is counted against them.
+		value_type(std::vector<_tokenizer::_token>::const_iterator& cursor, const std::vector<_tokenizer::_token>::const_iterator end, _limiter* limits = nullptr) {
 			// The token sequence goes depth first, so it's how it will be parsed recursively.
 
+			if (limits) {
+				limits->_node(sizeof(value_type), *cursor);
+			}
+
 			switch (cursor->_type) {
 
 				// Value is array
 			case _tokenizer::_token::_type_t::LEFT_SQUARE_BRACKET: {
 				_type = _type_t::ARRAY;
 				_array_alias arr;
+				if (limits && !_held_within) {
+					limits->_add_bytes(sizeof(_array_node) + 2 * sizeof(void*), *cursor);
+				}
 				++cursor;
 
 				// Is the array empty?
 				if (cursor->_type == _tokenizer::_token::_type_t::RIGHT_SQUARE_BRACKET) {
 					++cursor;
-					_value = arr;
+					_hold(std::move(arr));
 					return;
 				}
 
 				// Parse the array
 				while (cursor < end) {
-					arr.push_back(value_type<integer_type, floating_point_type, string_type>(cursor, end));
+					if (limits) {
+						limits->_container(arr.size() + 1, *cursor);
+					}
+					arr.push_back(value_type<integer_type, floating_point_type, string_type>(cursor, end, limits));
 					if (cursor != end) {
 						if (cursor->_type == _tokenizer::_token::_type_t::COMMA) {
 							++cursor;
@@ -746,7 +1826,7 @@ namespace euleristic::json {
 						}
 						else if (cursor->_type == _tokenizer::_token::_type_t::RIGHT_SQUARE_BRACKET) {
 							++cursor;
-							_value = arr;
+							_hold(std::move(arr));
 							return;
 						}
 						else {
@@ -763,12 +1843,15 @@ namespace euleristic::json {
 			case _tokenizer::_token::_type_t::LEFT_CURLY_BRACKET: {
 				_type = _type_t::OBJECT;
 				_object_alias obj;
+				if (limits && !_held_within) {
+					limits->_add_bytes(sizeof(_object_node) + 2 * sizeof(void*), *cursor);
+				}
 				++cursor;
 
 				// Is the object empty?
 				if (cursor->_type == _tokenizer::_token::_type_t::RIGHT_CURLY_BRACKET) {
 					++cursor;
-					_value = obj;
+					_hold(std::move(obj));
 					return;
 				}
 
@@ -781,6 +1864,11 @@ namespace euleristic::json {
 						throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, cursor->_line, cursor->_character };
 					}
 					auto key = _string_handler::_parse_string<string_type>(*cursor->_value, cursor->_line, cursor->_character);
+					if (limits) {
+						// The member's node, its link in a bucket, the hash of its key, and the key itself.
+						limits->_container(obj.size() + 1, *cursor);
+						limits->_string(key.size(), _heap_bytes(key) + 2 * sizeof(void*) + sizeof(size_t) + sizeof(string_type), *cursor);
+					}
 					++cursor;
 
 					// colon
@@ -793,13 +1881,13 @@ namespace euleristic::json {
 
 					// "value"
 					if (cursor == end) break;
-					obj[key] = value_type<integer_type, floating_point_type, string_type>(cursor, end);
+					obj[key] = value_type<integer_type, floating_point_type, string_type>(cursor, end, limits);
 
 					// comma or right curly bracket
 					if (cursor == end) break;
 					if (cursor->_type == _tokenizer::_token::_type_t::RIGHT_CURLY_BRACKET) {
 						++cursor;
-						_value = obj;
+						_hold(std::move(obj));
 						return;
 					}
 					if (cursor->_type != _tokenizer::_token::_type_t::COMMA) break;
@@ -813,6 +1901,7 @@ namespace euleristic::json {
 			case _tokenizer::_token::_type_t::NUMBER_LITERAL: {
 
 				// cursor is expected to be the next token, so we hang on to the number token and iterate cursor before evaluating the number
+				TIME_STATISTIC(number_time);
 				auto number = cursor;
 				++cursor;
 				try {
@@ -878,6 +1967,10 @@ namespace euleristic::json {
 			case _tokenizer::_token::_type_t::STRING_LITERAL: {
 				_type = _type_t::STRING;
 				_value = _string_handler::_parse_string<string_type>(*cursor->_value, cursor->_line, cursor->_character);
+				if (limits) {
+					auto& string = std::get<string_type>(*_value);
+					limits->_string(string.size(), _heap_bytes(string), *cursor);
+				}
 				++cursor;
 				return;
 			}
@@ -905,35 +1998,78 @@ namespace euleristic::json {
 			}
 		}
 
+		// Parses a whole token sequence, which must hold exactly one value, counting it against limits if given.
+		static value_type _parse_tokens(const std::vector<_tokenizer::_token>& token_sequence, _limiter* limits = nullptr) {
+			if (token_sequence.empty()) {
+				PUSH_TO_COUT("Source held no tokens!\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+
+			// Keep cursor so that we can know if all tokens were parsed
+			auto cursor = token_sequence.cbegin();
+			auto value = value_type(cursor, token_sequence.cend(), limits);
+
+			if (cursor != token_sequence.cend()) {
+				PUSH_TO_COUT("Unexpected token at (" << cursor->_line << ", " << cursor->_character << "), the source already had a value but continued.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, cursor->_line, cursor->_character };
+			}
+#ifdef EULERISTIC_JSON_STATS
+			value._account(_statistics::_current.allocations, _statistics::_current.allocated_bytes, nullptr);
+#endif //EULERISTIC_JSON_STATS
+			return value;
+		}
+
 	public:
+		// The types a JSON value may be of.
+		using type_t = _type_t;
+
 		// Default is JSON value null.
 		value_type() : _value({}), _type(_type_t::NULL_VALUE) {}
 
+		// Copies are deep, unless EULERISTIC_JSON_COPY_ON_WRITE is defined, in which case they share the arrays and objects of other,
+		// and references mutable_at has handed out into other end.
+		value_type(const value_type& other) : _type(other._type) {
+			if (auto array = _type == _type_t::ARRAY ? std::get_if<std::shared_ptr<_array_node>>(&*other._value) : nullptr) {
+				_copy(*array);
+			}
+			else if (auto object = _type == _type_t::OBJECT ? std::get_if<std::shared_ptr<_object_node>>(&*other._value) : nullptr) {
+				_copy(*object);
+			}
+			else {
+				_value = other._value;
+			}
+		}
+
+		// Copies before assigning, since other may be held within this, and freed by the assignment.
+		value_type& operator=(const value_type& other) {
+			value_type copy(other);
+			return *this = std::move(copy);
+		}
+
+		value_type(value_type&&) noexcept = default;
+		value_type& operator=(value_type&&) noexcept = default;
+
 		// Interface
 
 		// Constructs a JSON object from a std::unordered_map.
-		value_type(const std::unordered_map<string_type, value_type<integer_type, floating_point_type, string_type>>& obj) {
-			_type = _type_t::OBJECT;
-			_value = obj;
+		value_type(std::unordered_map<string_type, value_type<integer_type, floating_point_type, string_type>> obj) {
+			_hold(std::move(obj));
 		}
 
 		// Constructs a JSON object from a std::map.
 		value_type(const std::map<string_type, value_type<integer_type, floating_point_type, string_type>>& obj) {
-			_type = _type_t::OBJECT;
-			_value = std::unordered_map<string_type, value_type<integer_type, floating_point_type, string_type>>(obj.cbegin(), obj.cend());
+			_hold(_object_alias(obj.cbegin(), obj.cend()));
 		}
 
 		// Constructs a JSON array from a std::array.
 		template <size_t size>
 		value_type(const std::array<value_type<integer_type, floating_point_type, string_type>, size> arr) {
-			_type = _type_t::ARRAY;
-			_value = std::vector<value_type>(arr.cbegin(), arr.cend());
+			_hold(_array_alias(arr.cbegin(), arr.cend()));
 		}
 
 		// Constructs a JSON array from a std::vector.
-		value_type(const std::vector<value_type<integer_type, floating_point_type, string_type>> vec) {
-			_type = _type_t::ARRAY;
-			_value = vec;
+		value_type(std::vector<value_type<integer_type, floating_point_type, string_type>> vec) {
+			_hold(std::move(vec));
 		}
 
 		// Constructs a JSON string from a string
@@ -974,7 +2110,7 @@ namespace euleristic::json {
 			if (_type != _type_t::ARRAY) {
 				throw interface_misuse::INCORRECT_TYPE;
 			}
-			auto& arr = std::get<_array_alias>(*_value);
+			auto& arr = _array();
 			if (index >= arr.size()) {
 				throw interface_misuse::INDEX_OUT_OF_RANGE;
 			}
@@ -987,7 +2123,7 @@ namespace euleristic::json {
 			if (_type != _type_t::OBJECT) {
 				throw interface_misuse::INCORRECT_TYPE;
 			}
-			auto& obj = std::get<_object_alias>(*_value);
+			auto& obj = _object();
 			if (!obj.contains(key)) {
 				throw interface_misuse::NO_SUCH_KEY;
 			}
@@ -998,6 +2134,39 @@ namespace euleristic::json {
 			return _value.has_value();
 		}
 
+		// Returns the bytes held by the value: its own size, and the allocations of its string, or of its array or object
+		// and everything in it, including the nodes and buckets of hash tables. Arrays and objects which are shared within it,
+		// such as after deduplicate, are counted once. Sizes are as laid out by libstdc++; with other standard libraries,
+		// which lay out shared pointers and hash tables slightly differently, it is an estimate.
+		[[nodiscard]] size_t memory_usage() const {
+			size_t allocations = 0;
+			size_t bytes = sizeof(value_type);
+			std::unordered_set<const void*> seen;
+			_account(allocations, bytes, &seen);
+			return bytes;
+		}
+
+		// Returns the type of the held value.
+		[[nodiscard]] type_t type() const {
+			return _type;
+		}
+
+		// Calls visitor with the held value, as one of: nullptr, bool, integer_type, floating_point_type, const string_type&,
+		// std::span<const value_type> for an array or const std::unordered_map<string_type, value_type>& for an object, and returns what it returns.
+		// Every call must return the same type as visitor(nullptr).
+		template <typename visitor_type>
+		decltype(auto) visit(visitor_type&& visitor) const {
+			switch (_type) {
+			case _type_t::OBJECT:         return std::invoke(std::forward<visitor_type>(visitor), _object());
+			case _type_t::ARRAY:          return std::invoke(std::forward<visitor_type>(visitor), std::span<const value_type>(_array()));
+			case _type_t::INTEGER:        return std::invoke(std::forward<visitor_type>(visitor), std::get<integer_type>(*_value));
+			case _type_t::FLOATING_POINT: return std::invoke(std::forward<visitor_type>(visitor), std::get<floating_point_type>(*_value));
+			case _type_t::STRING:         return std::invoke(std::forward<visitor_type>(visitor), std::get<string_type>(*_value));
+			case _type_t::BOOLEAN:        return std::invoke(std::forward<visitor_type>(visitor), std::get<bool>(*_value));
+			default:                      return std::invoke(std::forward<visitor_type>(visitor), nullptr);
+			}
+		}
+
 		// Returns whether this is value null
 		[[nodiscard]] bool is_null() const {
 			return !_value;
@@ -1040,7 +2209,7 @@ namespace euleristic::json {
 			if (_type != _type_t::ARRAY) {
 				throw interface_misuse::INCORRECT_TYPE;
 			}
-			auto& arr = std::get<_array_alias>(*_value);
+			auto& arr = _array();
 			return std::span{ arr.cbegin(), arr.size() };
 		}
 
@@ -1049,9 +2218,97 @@ namespace euleristic::json {
 			if (_type != _type_t::OBJECT) {
 				throw interface_misuse::INCORRECT_TYPE;
 			}
-			auto& obj = std::get<_object_alias>(*_value);
+			auto& obj = _object();
 			return std::unordered_map{ obj.cbegin(), obj.cend() };
 		}
+
+		// Modification. With EULERISTIC_JSON_COPY_ON_WRITE, copies of a value share its arrays and objects, so that copying is cheap.
+		// A modification first copies the arrays and objects on the way to what is modified, if they are shared, but nothing else,
+		// and other copies are left as they were.
+
+		// If this is an array, returns the value at index for modification. The reference may be written through until this array,
+		// or one above it, is next modified other than by mutable_at, and with EULERISTIC_JSON_COPY_ON_WRITE until this, or a value
+		// above it, is copied, since the copy then shares the array. Until then, the array is rendered rather than cached.
+		[[nodiscard]] value_type<integer_type, floating_point_type, string_type>& mutable_at(const size_t index) {
+			if (_type != _type_t::ARRAY) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			if (index >= _array().size()) {
+				throw interface_misuse::INDEX_OUT_OF_RANGE;
+			}
+			auto& element = _mutable_array()[index];
+#if defined(EULERISTIC_JSON_COPY_ON_WRITE) || defined(EULERISTIC_JSON_SERIALIZATION_CACHE)
+			std::get<std::shared_ptr<_array_node>>(*_value)->_exposed.store(true, std::memory_order_relaxed);
+#endif //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
+			return element;
+		}
+
+		// If this is an object, returns the value at key for modification. The reference may be written through for as long as for arrays.
+		[[nodiscard]] value_type<integer_type, floating_point_type, string_type>& mutable_at(const std::convertible_to<string_type> auto& key) {
+			if (_type != _type_t::OBJECT) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			if (!_object().contains(key)) {
+				throw interface_misuse::NO_SUCH_KEY;
+			}
+			auto& member = _mutable_object().find(key)->second;
+#if defined(EULERISTIC_JSON_COPY_ON_WRITE) || defined(EULERISTIC_JSON_SERIALIZATION_CACHE)
+			std::get<std::shared_ptr<_object_node>>(*_value)->_exposed.store(true, std::memory_order_relaxed);
+#endif //EULERISTIC_JSON_COPY_ON_WRITE || EULERISTIC_JSON_SERIALIZATION_CACHE
+			return member;
+		}
+
+		// If this is an array, appends value to it.
+		void push_back(value_type<integer_type, floating_point_type, string_type> value) {
+			if (_type != _type_t::ARRAY) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			_mutable_array().push_back(std::move(value));
+		}
+
+		// If this is an array, inserts value before index, which may be its size.
+		void insert(const size_t index, value_type<integer_type, floating_point_type, string_type> value) {
+			if (_type != _type_t::ARRAY) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			if (index > _array().size()) {
+				throw interface_misuse::INDEX_OUT_OF_RANGE;
+			}
+			auto& arr = _mutable_array();
+			arr.insert(arr.begin() + index, std::move(value));
+		}
+
+		// If this is an object, sets the value at key, adding key if it is not there.
+		void insert_or_assign(string_type key, value_type<integer_type, floating_point_type, string_type> value) {
+			if (_type != _type_t::OBJECT) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			_mutable_object().insert_or_assign(std::move(key), std::move(value));
+		}
+
+		// If this is an array, removes the value at index.
+		void erase(const size_t index) {
+			if (_type != _type_t::ARRAY) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			if (index >= _array().size()) {
+				throw interface_misuse::INDEX_OUT_OF_RANGE;
+			}
+			auto& arr = _mutable_array();
+			arr.erase(arr.begin() + index);
+		}
+
+		// If this is an object, removes the value at key. Returns whether there was one.
+		bool erase(const std::convertible_to<string_type> auto& key) {
+			if (_type != _type_t::OBJECT) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			if (!_object().contains(key)) {
+				return false;
+			}
+			_mutable_object().erase(key);
+			return true;
+		}
 	};
 
 	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
@@ -1071,68 +2328,933 @@ namespace euleristic::json {
 		}
 	};
 
-	// Parses JSON source text.
-	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
-	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_text(const std::string_view source) {
+	// Compares whole values, stopping at the first difference. Values of different types, including integers and floating point numbers, are never equal.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] bool operator==(const value_type<integer_type, floating_point_type, string_type>& lhs,
+		const value_type<integer_type, floating_point_type, string_type>& rhs) {
+		using value_t = value_type<integer_type, floating_point_type, string_type>;
 
-		if (source.empty()) {
-			PUSH_TO_COUT("Source was empty!\n");
-			throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+		if (&lhs == &rhs) {
+			return true;
+		}
+		if (lhs._type != rhs._type) {
+			return false;
+		}
+		switch (lhs._type) {
+		case value_t::_type_t::NULL_VALUE:     return true;
+		case value_t::_type_t::BOOLEAN:        return std::get<bool>(*lhs._value) == std::get<bool>(*rhs._value);
+		case value_t::_type_t::INTEGER:        return std::get<integer_type>(*lhs._value) == std::get<integer_type>(*rhs._value);
+		case value_t::_type_t::FLOATING_POINT: return std::get<floating_point_type>(*lhs._value) == std::get<floating_point_type>(*rhs._value);
+		case value_t::_type_t::STRING:         return std::get<string_type>(*lhs._value) == std::get<string_type>(*rhs._value);
+		case value_t::_type_t::ARRAY: {
+			auto& lhs_array = lhs._array();
+			auto& rhs_array = rhs._array();
+			if (&lhs_array == &rhs_array) {
+				return true;
+			}
+			return std::equal(lhs_array.begin(), lhs_array.end(), rhs_array.begin(), rhs_array.end());
+		}
+		case value_t::_type_t::OBJECT: {
+			auto& lhs_object = lhs._object();
+			auto& rhs_object = rhs._object();
+			if (&lhs_object == &rhs_object) {
+				return true;
+			}
+			if (lhs_object.size() != rhs_object.size()) {
+				return false;
+			}
+			for (auto& [key, value] : lhs_object) {
+				auto it = rhs_object.find(key);
+				if (it == rhs_object.end() || !(value == it->second)) {
+					return false;
+				}
+			}
+			return true;
+		}
 		}
+		return false;
+	};
 
-		auto token_sequence = _tokenizer::_tokenize(source);
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to.
+	// Compares whole values as operator== does, but with numbers equal when their values are, whether held as integers or floating point numbers,
+	// as JSON Patch (RFC 6902) and JSONPath (RFC 9535) compare them. So 1 equals 1.0, and [1] equals [1.0].
+	class _numeric_equality {
+
+		// Whether number is integer. It must be integral, and within the range of integer_type, to be converted to it exactly.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		static bool _same_number(const integer_type integer, const floating_point_type number) {
+			constexpr auto lowest = static_cast<floating_point_type>(std::numeric_limits<integer_type>::min());
+			// One past the largest integer is a power of two, and so converts exactly, which the largest integer may not.
+			constexpr auto past_highest = static_cast<floating_point_type>(std::numeric_limits<integer_type>::max() / 2 + 1) * 2;
+			return number == std::trunc(number) && number >= lowest && number < past_highest && static_cast<integer_type>(number) == integer;
+		}
 
-		// Keep cursor so that we can know if all tokens were parsed
-		auto cursor = token_sequence.cbegin();
-		auto value = value_type<integer_type, floating_point_type, string_type>(cursor, token_sequence.cend());
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static bool _equal(const value_type<integer_type, floating_point_type, string_type>& lhs, const value_type<integer_type, floating_point_type, string_type>& rhs) {
+			using value_t = value_type<integer_type, floating_point_type, string_type>;
 
-		if (cursor != token_sequence.cend()) {
-			PUSH_TO_COUT("Unexpected token at (" << cursor->_line << ", " << cursor->_character << "), the source already had a value but continued.\n");
-			throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, cursor->_line, cursor->_character };
+			if (lhs._type == value_t::_type_t::INTEGER && rhs._type == value_t::_type_t::FLOATING_POINT) {
+				return _same_number(std::get<integer_type>(*lhs._value), std::get<floating_point_type>(*rhs._value));
+			}
+			if (lhs._type == value_t::_type_t::FLOATING_POINT && rhs._type == value_t::_type_t::INTEGER) {
+				return _same_number(std::get<integer_type>(*rhs._value), std::get<floating_point_type>(*lhs._value));
+			}
+			if (lhs._type != rhs._type) {
+				return false;
+			}
+			switch (lhs._type) {
+			case value_t::_type_t::ARRAY: {
+				auto& lhs_array = lhs._array();
+				auto& rhs_array = rhs._array();
+				return &lhs_array == &rhs_array || std::equal(lhs_array.begin(), lhs_array.end(), rhs_array.begin(), rhs_array.end(),
+					[](const value_t& lhs_element, const value_t& rhs_element) { return _equal(lhs_element, rhs_element); });
+			}
+			case value_t::_type_t::OBJECT: {
+				auto& lhs_object = lhs._object();
+				auto& rhs_object = rhs._object();
+				if (&lhs_object == &rhs_object) {
+					return true;
+				}
+				if (lhs_object.size() != rhs_object.size()) {
+					return false;
+				}
+				for (auto& [key, value] : lhs_object) {
+					auto it = rhs_object.find(key);
+					if (it == rhs_object.end() || !_equal(value, it->second)) {
+						return false;
+					}
+				}
+				return true;
+			}
+			default:
+				return lhs == rhs;
+			}
 		}
 
-		PUSH_TO_COUT("Source was successfully parsed.\n");
-
-		return value;
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class json_patch;
+		template <string_concept S>
+		friend class json_path;
 	};
 
-	// Reads the JSON file at path and calls parse_text with the read source text.
-	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
-	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_file(const std::filesystem::path path) {
-		if (path.extension() != ".json") {
-			PUSH_TO_COUT("Unexpected file extension of path: " << path << ", expected .json\n");
-			throw parsing_error{ parsing_error::type_t::INCORRECT_FILE_EXTENSION, {}, {} };
-		}
-
-		std::error_code ec;
+#if defined(EULERISTIC_JSON_ZLIB) || defined(EULERISTIC_JSON_ZSTD)
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	class _compression {
 
-		if (!std::filesystem::exists(path, ec)) {
-			PUSH_TO_COUT("No file found at path: " << path << "\nstd::filesystem::exists gave error code " << ec.value() << ':' << ec.message() << '\n');
-			throw parsing_error{ parsing_error::type_t::FILE_NOT_FOUND, {}, {} };
+		// The supported compression formats.
+		enum class _codec_t {
+			GZIP,
+			ZSTD
 		};
 
-		PUSH_TO_COUT("Reading file: " << path << '\n');
-		std::ifstream file(path);
+		// Size of the chunks handed between the threads of a pipeline.
+		static constexpr size_t _chunk_size = size_t(1) << 18;
+
+		// A bounded queue which hands chunks from a producing thread to a consuming thread.
+		class _chunk_queue {
+			static constexpr size_t _capacity = 4;
+
+			std::mutex _mutex;
+			std::condition_variable _condition;
+			std::deque<std::string> _chunks;
+			bool _closed = false;
+			bool _abandoned = false;
+			std::exception_ptr _producer_error, _consumer_error;
+
+		public:
+			// Blocks while the queue is full. Returns false if the consumer has abandoned the queue.
+			bool _push(std::string chunk) {
+				std::unique_lock lock(_mutex);
+				_condition.wait(lock, [this] { return _chunks.size() < _capacity || _abandoned; });
+				if (_abandoned) {
+					return false;
+				}
+				_chunks.push_back(std::move(chunk));
+				_condition.notify_all();
+				return true;
+			}
 
-		if (!file.is_open()) {
-			PUSH_TO_COUT("Could not read file.\n");
-			throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
-		}
+			// Blocks while the queue is empty. Returns no chunk once the producer has closed the queue,
+			// or rethrows the error the producer closed it with.
+			std::optional<std::string> _pop() {
+				std::unique_lock lock(_mutex);
+				_condition.wait(lock, [this] { return !_chunks.empty() || _closed; });
+				if (_chunks.empty()) {
+					if (_producer_error) {
+						std::rethrow_exception(_producer_error);
+					}
+					return {};
+				}
+				auto chunk = std::move(_chunks.front());
+				_chunks.pop_front();
+				_condition.notify_all();
+				return chunk;
+			}
 
-		std::basic_stringstream<char> buffer;
-		buffer << file.rdbuf();
+			// Called by the producer once it is done, with the error it failed with, if any.
+			void _close(const std::exception_ptr error = nullptr) {
+				std::lock_guard lock(_mutex);
+				_closed = true;
+				_producer_error = error;
+				_condition.notify_all();
+			}
 
+			// Called by the consumer if it stops consuming, with the error it failed with, if any.
+			void _abandon(const std::exception_ptr error = nullptr) {
+				std::lock_guard lock(_mutex);
+				_abandoned = true;
+				_consumer_error = error;
+				_condition.notify_all();
+			}
 
-		return parse_text<integer_type, floating_point_type, string_type>(buffer.view());
-	};
+			// The error the consumer abandoned the queue with, if any.
+			std::exception_ptr _abandon_error() {
+				std::lock_guard lock(_mutex);
+				return _consumer_error;
+			}
+		};
 
-	// Writes a JSON value to the file at path.
-	template <std::integral integer_type = int, std::floating_point floating_point_type = float, string_concept string_type = std::string>
-	void write_to_file(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path) {
+		// Returns the compression format implied by the extension of path, if it is compiled in.
+		static std::optional<_codec_t> _codec_of(const std::filesystem::path& path) {
+#ifdef EULERISTIC_JSON_ZLIB
+			if (path.extension() == ".gz") return _codec_t::GZIP;
+#endif //EULERISTIC_JSON_ZLIB
+#ifdef EULERISTIC_JSON_ZSTD
+			if (path.extension() == ".zst") return _codec_t::ZSTD;
+#endif //EULERISTIC_JSON_ZSTD
+			return {};
+		}
+
+#ifdef EULERISTIC_JSON_ZLIB
+		// Decompresses the gzip (or zlib) file into queue. Concatenated gzip members are decompressed one after another.
+		static void _inflate(std::istream& file, _chunk_queue& queue) {
+			z_stream stream{};
+			if (inflateInit2(&stream, 15 + 32) != Z_OK) {
+				throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+			}
+			std::unique_ptr<z_stream, decltype(&inflateEnd)> stream_guard(&stream, &inflateEnd);
+
+			std::string input(_chunk_size, '\0');
+			bool stream_ended = false;
+			while (file.read(input.data(), input.size()) || file.gcount() != 0) {
+				stream.next_in = reinterpret_cast<Bytef*>(input.data());
+				stream.avail_in = static_cast<uInt>(file.gcount());
+				for (;;) {
+					std::string output(_chunk_size, '\0');
+					stream.next_out = reinterpret_cast<Bytef*>(output.data());
+					stream.avail_out = static_cast<uInt>(output.size());
+					const int result = inflate(&stream, Z_NO_FLUSH);
+					if (result != Z_OK && result != Z_STREAM_END && result != Z_BUF_ERROR) {
+						PUSH_TO_COUT("Could not inflate file, zlib gave error code " << result << ".\n");
+						throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+					}
+					output.resize(output.size() - stream.avail_out);
+					if (!output.empty() && !queue._push(std::move(output))) {
+						return;
+					}
+					stream_ended = result == Z_STREAM_END;
+					if (stream_ended && stream.avail_in != 0) {
+						inflateReset(&stream);
+						continue;
+					}
+					if (stream.avail_in == 0 && stream.avail_out != 0) {
+						break;
+					}
+				}
+			}
+			if (!stream_ended) {
+				PUSH_TO_COUT("Compressed file ended unexpectedly.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+		}
+
+		// Compresses the chunks of queue into the file as gzip.
+		static void _deflate(_chunk_queue& queue, std::ostream& file) {
+			z_stream stream{};
+			if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK) {
+				throw format_error::CONVERSION_FAILURE;
+			}
+			std::unique_ptr<z_stream, decltype(&deflateEnd)> stream_guard(&stream, &deflateEnd);
+
+			std::string output(_chunk_size, '\0');
+			auto deflate_chunk = [&](std::string& chunk, const int flush) {
+				stream.next_in = reinterpret_cast<Bytef*>(chunk.data());
+				stream.avail_in = static_cast<uInt>(chunk.size());
+				int result;
+				do {
+					stream.next_out = reinterpret_cast<Bytef*>(output.data());
+					stream.avail_out = static_cast<uInt>(output.size());
+					result = deflate(&stream, flush);
+					if (result == Z_STREAM_ERROR) {
+						throw format_error::CONVERSION_FAILURE;
+					}
+					if (!file.write(output.data(), output.size() - stream.avail_out)) {
+						throw format_error::FILE_WRITE_ERROR;
+					}
+				} while (stream.avail_out == 0 || (flush == Z_FINISH && result != Z_STREAM_END));
+			};
+
+			while (auto chunk = queue._pop()) {
+				deflate_chunk(*chunk, Z_NO_FLUSH);
+			}
+			std::string last;
+			deflate_chunk(last, Z_FINISH);
+		}
+#endif //EULERISTIC_JSON_ZLIB
+
+#ifdef EULERISTIC_JSON_ZSTD
+		// Decompresses the zstd file into queue.
+		static void _zstd_decompress(std::istream& file, _chunk_queue& queue) {
+			std::unique_ptr<ZSTD_DStream, decltype(&ZSTD_freeDStream)> stream(ZSTD_createDStream(), &ZSTD_freeDStream);
+			if (!stream || ZSTD_isError(ZSTD_initDStream(stream.get()))) {
+				throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+			}
+
+			std::string input(ZSTD_DStreamInSize(), '\0');
+			size_t result = 0;
+			while (file.read(input.data(), input.size()) || file.gcount() != 0) {
+				ZSTD_inBuffer in{ input.data(), static_cast<size_t>(file.gcount()), 0 };
+				for (;;) {
+					std::string output(_chunk_size, '\0');
+					ZSTD_outBuffer out{ output.data(), output.size(), 0 };
+					result = ZSTD_decompressStream(stream.get(), &out, &in);
+					if (ZSTD_isError(result)) {
+						PUSH_TO_COUT("Could not decompress file, zstd gave error: " << ZSTD_getErrorName(result) << ".\n");
+						throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+					}
+					output.resize(out.pos);
+					if (!output.empty() && !queue._push(std::move(output))) {
+						return;
+					}
+					if (in.pos == in.size && out.pos != out.size) {
+						break;
+					}
+				}
+			}
+			if (result != 0) {
+				PUSH_TO_COUT("Compressed file ended unexpectedly.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+		}
+
+		// Compresses the chunks of queue into the file as zstd.
+		static void _zstd_compress(_chunk_queue& queue, std::ostream& file) {
+			std::unique_ptr<ZSTD_CCtx, decltype(&ZSTD_freeCCtx)> context(ZSTD_createCCtx(), &ZSTD_freeCCtx);
+			if (!context) {
+				throw format_error::CONVERSION_FAILURE;
+			}
+
+			std::string output(ZSTD_CStreamOutSize(), '\0');
+			auto compress_chunk = [&](const std::string& chunk, const ZSTD_EndDirective directive) {
+				ZSTD_inBuffer in{ chunk.data(), chunk.size(), 0 };
+				size_t remaining;
+				do {
+					ZSTD_outBuffer out{ output.data(), output.size(), 0 };
+					remaining = ZSTD_compressStream2(context.get(), &out, &in, directive);
+					if (ZSTD_isError(remaining)) {
+						throw format_error::CONVERSION_FAILURE;
+					}
+					if (!file.write(output.data(), out.pos)) {
+						throw format_error::FILE_WRITE_ERROR;
+					}
+				} while (directive == ZSTD_e_end ? remaining != 0 : in.pos != in.size);
+			};
+
+			while (auto chunk = queue._pop()) {
+				compress_chunk(*chunk, ZSTD_e_continue);
+			}
+			compress_chunk({}, ZSTD_e_end);
+		}
+#endif //EULERISTIC_JSON_ZSTD
+
+		// Decompresses the file into queue with the given format.
+		static void _decompress(std::istream& file, const _codec_t codec, _chunk_queue& queue) {
+			switch (codec) {
+#ifdef EULERISTIC_JSON_ZLIB
+			case _codec_t::GZIP: _inflate(file, queue); return;
+#endif //EULERISTIC_JSON_ZLIB
+#ifdef EULERISTIC_JSON_ZSTD
+			case _codec_t::ZSTD: _zstd_decompress(file, queue); return;
+#endif //EULERISTIC_JSON_ZSTD
+			default: throw parsing_error{ parsing_error::type_t::INCORRECT_FILE_EXTENSION, {}, {} };
+			}
+		}
+
+		// Compresses the chunks of queue into the file with the given format.
+		static void _compress(_chunk_queue& queue, const _codec_t codec, std::ostream& file) {
+			switch (codec) {
+#ifdef EULERISTIC_JSON_ZLIB
+			case _codec_t::GZIP: _deflate(queue, file); return;
+#endif //EULERISTIC_JSON_ZLIB
+#ifdef EULERISTIC_JSON_ZSTD
+			case _codec_t::ZSTD: _zstd_compress(queue, file); return;
+#endif //EULERISTIC_JSON_ZSTD
+			default: throw format_error::CONVERSION_FAILURE;
+			}
+		}
+
+		// Decompresses the file on a separate thread, while tokenizing the decompressed chunks as they arrive, and parses the tokens.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static value_type<integer_type, floating_point_type, string_type> _parse_file(const std::filesystem::path& path, const _codec_t codec, _limiter* limits = nullptr) {
+			std::ifstream file(path, std::ios::binary);
+			if (!file.is_open()) {
+				PUSH_TO_COUT("Could not read file.\n");
+				throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+			}
+
+			_chunk_queue queue;
+			std::thread decompressor([&file, codec, &queue] {
+				try {
+					_decompress(file, codec, queue);
+					queue._close();
+				}
+				catch (...) {
+					queue._close(std::current_exception());
+				}
+			});
+
+			// Stops and joins the decompressor, also if tokenizing throws.
+			struct _join_guard {
+				_chunk_queue& _queue;
+				std::thread& _thread;
+				~_join_guard() {
+					_queue._abandon();
+					_thread.join();
+				}
+			} join_guard{ queue, decompressor };
+
+			// A token may straddle chunks, so what could not be tokenized is carried over to the next chunk. What is left of the carry
+			// after tokenizing it is the beginning of a single token, of length unfinished, and the carry is only tokenized again
+			// once it has doubled, as _limiter::_tokenize widens its window, so that a token which straddles many chunks is not
+			// scanned from its beginning for each of them.
+			std::vector<_tokenizer::_token> token_sequence;
+			uint16_t line = 1;
+			uint16_t character = 1;
+			std::string carry;
+			size_t unfinished = 0;
+			while (auto chunk = queue._pop()) {
+				const size_t first = token_sequence.size();
+				if (carry.empty()) {
+					auto consumed = _tokenizer::_tokenize(*chunk, token_sequence, line, character, false);
+					carry.assign(*chunk, consumed);
+					unfinished = carry.size();
+				}
+				else {
+					if (limits) {
+						limits->_pending(std::string_view(carry).substr(0, unfinished), carry.size(), line, character);
+					}
+					carry += *chunk;
+					if (carry.size() >= 2 * unfinished) {
+						carry.erase(0, _tokenizer::_tokenize(carry, token_sequence, line, character, false));
+						unfinished = carry.size();
+					}
+				}
+				if (limits) {
+					limits->_tokens(token_sequence, first);
+				}
+			}
+			const size_t first = token_sequence.size();
+			_tokenizer::_tokenize(carry, token_sequence, line, character, true);
+			if (limits) {
+				limits->_tokens(token_sequence, first);
+			}
+
+			return value_type<integer_type, floating_point_type, string_type>::_parse_tokens(token_sequence, limits);
+		}
+
+		// A stream buffer which hands what is written to it over to a thread which compresses it into a file.
+		class _compressing_streambuf : public std::streambuf {
+			std::ofstream _file;
+			_chunk_queue _queue;
+			std::string _buffer;
+			bool _finished = false;
+			std::thread _compressor;
+
+			// Hands the buffered characters over to the compressor and starts a new buffer.
+			bool _hand_off() {
+				_buffer.resize(pptr() - pbase());
+				const bool accepted = _queue._push(std::move(_buffer));
+				_buffer.assign(_chunk_size, '\0');
+				setp(_buffer.data(), _buffer.data() + _buffer.size());
+				return accepted;
+			}
+
+		protected:
+			int_type overflow(const int_type c) override {
+				if (!_hand_off()) {
+					return traits_type::eof();
+				}
+				if (!traits_type::eq_int_type(c, traits_type::eof())) {
+					*pptr() = traits_type::to_char_type(c);
+					pbump(1);
+				}
+				return traits_type::not_eof(c);
+			}
+
+		public:
+			_compressing_streambuf(const std::filesystem::path& path, const _codec_t codec) : _file(path, std::ios::binary), _buffer(_chunk_size, '\0') {
+				if (!_file.is_open()) {
+					PUSH_TO_COUT("Could not open file: " << path << '\n');
+					throw format_error::FILE_WRITE_ERROR;
+				}
+				setp(_buffer.data(), _buffer.data() + _buffer.size());
+				_compressor = std::thread([this, codec] {
+					try {
+						_compress(_queue, codec, _file);
+					}
+					catch (...) {
+						_queue._abandon(std::current_exception());
+					}
+				});
+			}
+
+			// Hands over what remains, waits for the compressor and rethrows any error it encountered, or throws if the file could not be written.
+			void _finish() {
+				if (pptr() != pbase()) {
+					_hand_off();
+				}
+				_queue._close();
+				_compressor.join();
+				_finished = true;
+				if (auto error = _queue._abandon_error()) {
+					std::rethrow_exception(error);
+				}
+				_file.close();
+				if (!_file) {
+					PUSH_TO_COUT("Could not write to file.\n");
+					throw format_error::FILE_WRITE_ERROR;
+				}
+			}
+
+			~_compressing_streambuf() {
+				if (!_finished) {
+					_queue._close();
+					_compressor.join();
+				}
+			}
+		};
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_file(const std::filesystem::path, const parse_options&);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend void write_to_file(const value_type<I, F, S>&, const std::filesystem::path, const write_options&);
+		friend class _parallel_writer;
+	};
+#endif //EULERISTIC_JSON_ZLIB || EULERISTIC_JSON_ZSTD
+
+	// Parses JSON source text.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_text(const std::string_view source) {
+
+		if (source.empty()) {
+			PUSH_TO_COUT("Source was empty!\n");
+			throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+		}
+
+#ifdef EULERISTIC_JSON_STATS
+		_statistics::_reset();
+#endif //EULERISTIC_JSON_STATS
+		auto token_sequence = _tokenizer::_tokenize(source);
+		auto value = value_type<integer_type, floating_point_type, string_type>::_parse_tokens(token_sequence);
+
+		PUSH_TO_COUT("Source was successfully parsed.\n");
+
+		return value;
+	};
+
+	// Parses JSON source text, throwing parsing_error LIMIT_EXCEEDED as soon as what is built exceeds a limit of options.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_text(const std::string_view source, const parse_options& options) {
+
+		if (!_limiter::_limits(options)) {
+			return parse_text<integer_type, floating_point_type, string_type>(source);
+		}
+
+		if (source.empty()) {
+			PUSH_TO_COUT("Source was empty!\n");
+			throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+		}
+
+#ifdef EULERISTIC_JSON_STATS
+		_statistics::_reset();
+#endif //EULERISTIC_JSON_STATS
+		_limiter limits(options);
+		auto token_sequence = limits._tokenize(source);
+		auto value = value_type<integer_type, floating_point_type, string_type>::_parse_tokens(token_sequence, &limits);
+
+		PUSH_TO_COUT("Source was successfully parsed.\n");
+
+		return value;
+	};
+
+	// Reads the JSON file at path and calls parse_text with the read source text.
+	// A compressed file is instead decompressed and tokenized concurrently.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_file(const std::filesystem::path path) {
+		return parse_file<integer_type, floating_point_type, string_type>(path, parse_options{});
+	};
+
+	// Reads the JSON file at path and calls parse_text with the read source text and options.
+	// A compressed file is instead decompressed and tokenized concurrently, and its tokens are counted against the limits as they come.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_file(const std::filesystem::path path, const parse_options& options) {
+#ifdef EULERISTIC_JSON_STATS
+		_statistics::_reset();
+#endif //EULERISTIC_JSON_STATS
+#if defined(EULERISTIC_JSON_ZLIB) || defined(EULERISTIC_JSON_ZSTD)
+		const auto codec = _compression::_codec_of(path);
+		if (codec && path.stem().extension() != ".json") {
+			PUSH_TO_COUT("Unexpected file extension of path: " << path << ", expected .json before the compression extension\n");
+			throw parsing_error{ parsing_error::type_t::INCORRECT_FILE_EXTENSION, {}, {} };
+		}
+		if (!codec && path.extension() != ".json") {
+#else //EULERISTIC_JSON_ZLIB || EULERISTIC_JSON_ZSTD
+		if (path.extension() != ".json") {
+#endif //EULERISTIC_JSON_ZLIB || EULERISTIC_JSON_ZSTD
+			PUSH_TO_COUT("Unexpected file extension of path: " << path << ", expected .json\n");
+			throw parsing_error{ parsing_error::type_t::INCORRECT_FILE_EXTENSION, {}, {} };
+		}
+
+		std::error_code ec;
+
+		if (!std::filesystem::exists(path, ec)) {
+			PUSH_TO_COUT("No file found at path: " << path << "\nstd::filesystem::exists gave error code " << ec.value() << ':' << ec.message() << '\n');
+			throw parsing_error{ parsing_error::type_t::FILE_NOT_FOUND, {}, {} };
+		};
+
+		PUSH_TO_COUT("Reading file: " << path << '\n');
+
+#if defined(EULERISTIC_JSON_ZLIB) || defined(EULERISTIC_JSON_ZSTD)
+		if (codec) {
+			_limiter limits(options);
+			auto value = _compression::_parse_file<integer_type, floating_point_type, string_type>(path, *codec, _limiter::_limits(options) ? &limits : nullptr);
+			PUSH_TO_COUT("Source was successfully parsed.\n");
+			return value;
+		}
+#endif //EULERISTIC_JSON_ZLIB || EULERISTIC_JSON_ZSTD
+
+		std::ifstream file(path);
+
+		if (!file.is_open()) {
+			PUSH_TO_COUT("Could not read file.\n");
+			throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+		}
+
+		std::basic_stringstream<char> buffer;
+		buffer << file.rdbuf();
+
+
+		return parse_text<integer_type, floating_point_type, string_type>(buffer.view(), options);
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	// A stream buffer which fills a large aligned buffer and writes it to a file in one call, as write_options asks.
+	class _buffered_file : public std::streambuf {
+		static constexpr size_t _alignment = 4096;
+
+		std::filesystem::path _path;
+		std::filesystem::path _target;
+		size_t _size;
+		char* _buffer;
+		size_t _written = 0;
+		bool _finished = false;
+
+#ifdef EULERISTIC_JSON_POSIX_IO
+		int _file = -1;
+		bool _direct = false;
+		bool _preallocated = false;
+#else //EULERISTIC_JSON_POSIX_IO
+		std::ofstream _file;
+#endif //EULERISTIC_JSON_POSIX_IO
+
+		void _write_all(const char* data, size_t size) {
+#ifdef EULERISTIC_JSON_POSIX_IO
+			while (size != 0) {
+				const ssize_t written = ::write(_file, data, size);
+				if (written < 0) {
+					if (errno == EINTR) {
+						continue;
+					}
+					PUSH_TO_COUT("Could not write to file: " << _path << '\n');
+					throw format_error::FILE_WRITE_ERROR;
+				}
+				data += written;
+				size -= static_cast<size_t>(written);
+				_written += static_cast<size_t>(written);
+			}
+#else //EULERISTIC_JSON_POSIX_IO
+			if (!_file.write(data, static_cast<std::streamsize>(size))) {
+				PUSH_TO_COUT("Could not write to file: " << _path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+			_written += size;
+#endif //EULERISTIC_JSON_POSIX_IO
+		}
+
+		void _write_buffer() {
+			const size_t size = static_cast<size_t>(pptr() - pbase());
+
+#if defined(EULERISTIC_JSON_POSIX_IO) && defined(O_DIRECT)
+			// Only whole blocks may be written directly, which every buffer but the last one is.
+			if (_direct && size % _alignment != 0) {
+				::fcntl(_file, F_SETFL, ::fcntl(_file, F_GETFL) & ~O_DIRECT);
+				_direct = false;
+			}
+#endif //EULERISTIC_JSON_POSIX_IO && O_DIRECT
+
+			_write_all(_buffer, size);
+			setp(_buffer, _buffer + _size);
+		}
+
+		int_type overflow(const int_type c) override {
+			_write_buffer();
+			if (!traits_type::eq_int_type(c, traits_type::eof())) {
+				*pptr() = traits_type::to_char_type(c);
+				pbump(1);
+			}
+			return traits_type::not_eof(c);
+		}
+
+		std::streamsize xsputn(const char* data, const std::streamsize count) override {
+			size_t remaining = static_cast<size_t>(count);
+			while (remaining != 0) {
+				if (pptr() == epptr()) {
+					_write_buffer();
+				}
+				const size_t size = std::min(remaining, static_cast<size_t>(epptr() - pptr()));
+				std::memcpy(pptr(), data, size);
+				pbump(static_cast<int>(size));
+				data += size;
+				remaining -= size;
+			}
+			return count;
+		}
+
+		void _close() {
+#ifdef EULERISTIC_JSON_POSIX_IO
+			if (_file >= 0) {
+				::close(_file);
+				_file = -1;
+			}
+#else //EULERISTIC_JSON_POSIX_IO
+			_file.close();
+#endif //EULERISTIC_JSON_POSIX_IO
+		}
+
+		// A name for a temporary file beside path, such as data.json.5f0c3a9e12b4d687.tmp, which no other writer is likely to choose.
+		// Each thread counts from the address of its count, which differs between the threads of a process, and between processes where
+		// addresses are randomized, mixed with the time. The name is still only likely to be new, so it is retried if the file exists.
+		static std::filesystem::path _temporary_path(const std::filesystem::path& path) {
+			thread_local uint64_t state = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(&state)) ^ (static_cast<uint64_t>(std::time(nullptr)) << 24);
+			static constexpr char digits[] = "0123456789abcdef";
+			state += 0x9E3779B97F4A7C15;
+			uint64_t bits = (state ^ (state >> 30)) * 0xBF58476D1CE4E5B9;
+			bits = (bits ^ (bits >> 27)) * 0x94D049BB133111EB;
+			bits ^= bits >> 31;
+			std::string name = ".";
+			for (size_t i = 0; i < 16; ++i, bits >>= 4) {
+				name += digits[bits & 0xF];
+			}
+			return std::filesystem::path(path).concat(name + ".tmp");
+		}
+
+	public:
+		_buffered_file(const std::filesystem::path& path, const write_options& options)
+			: _path(path), _target(path),
+			_size(std::max(_alignment, (options.buffer_size + _alignment - 1) / _alignment * _alignment)),
+			_buffer(static_cast<char*>(::operator new(_size, std::align_val_t(_alignment)))) {
+
+			setp(_buffer, _buffer + _size);
+
+#ifdef EULERISTIC_JSON_POSIX_IO
+			// A temporary file must be a new one, so that no other file is overwritten, and is retried under another name if it is not.
+			int flags = O_WRONLY | O_CREAT | (options.atomic ? O_EXCL : O_TRUNC);
+#ifdef O_DIRECT
+			if (options.direct) {
+				flags |= O_DIRECT;
+				_direct = true;
+			}
+#endif //O_DIRECT
+			do {
+				if (options.atomic) {
+					_path = _temporary_path(path);
+				}
+				_file = ::open(_path.c_str(), flags, 0666);
+				if (_file < 0 && _direct) {
+					// Not every file system supports O_DIRECT.
+					_direct = false;
+					flags &= ~O_DIRECT;
+					_file = ::open(_path.c_str(), flags, 0666);
+				}
+			} while (_file < 0 && options.atomic && errno == EEXIST);
+			if (_file < 0) {
+				::operator delete(_buffer, std::align_val_t(_alignment));
+				PUSH_TO_COUT("Could not open file: " << _path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+
+#if defined(_POSIX_ADVISORY_INFO) && _POSIX_ADVISORY_INFO > 0
+			if (options.expected_size) {
+				_preallocated = ::posix_fallocate(_file, 0, static_cast<off_t>(*options.expected_size)) == 0;
+			}
+#endif //_POSIX_ADVISORY_INFO
+#else //EULERISTIC_JSON_POSIX_IO
+			if (options.atomic) {
+				do {
+					_path = _temporary_path(path);
+				} while (std::filesystem::exists(_path));
+			}
+			_file.open(_path, std::ios::binary);
+			if (!_file.is_open()) {
+				::operator delete(_buffer, std::align_val_t(_alignment));
+				PUSH_TO_COUT("Could not open file: " << _path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+#endif //EULERISTIC_JSON_POSIX_IO
+		}
+
+		_buffered_file(const _buffered_file&) = delete;
+		_buffered_file& operator=(const _buffered_file&) = delete;
+
+		// Closes the file, and removes it if it was a temporary one which was never finished.
+		~_buffered_file() {
+			_close();
+			if (!_finished && _path != _target) {
+				std::error_code ec;
+				std::filesystem::remove(_path, ec);
+			}
+			::operator delete(_buffer, std::align_val_t(_alignment));
+		}
+
+		// Writes texts after what has been written so far. Where it is supported, they are gathered straight from where they are held
+		// into as few calls as possible, rather than copied through the buffer, which direct writes still go through, as they need aligned memory.
+		void _write_gathered(const std::vector<std::string_view>& texts) {
+#ifdef EULERISTIC_JSON_POSIX_IO
+			if (!_direct) {
+				_write_buffer();
+				std::vector<iovec> vectors;
+				vectors.reserve(texts.size());
+				for (auto text : texts) {
+					if (!text.empty()) {
+						vectors.push_back({ const_cast<char*>(text.data()), text.size() });
+					}
+				}
+
+				constexpr size_t max_vectors = IOV_MAX;
+				for (size_t first = 0; first != vectors.size();) {
+					const int count = static_cast<int>(std::min(max_vectors, vectors.size() - first));
+					const ssize_t written = ::writev(_file, vectors.data() + first, count);
+					if (written < 0) {
+						if (errno == EINTR) {
+							continue;
+						}
+						PUSH_TO_COUT("Could not write to file: " << _path << '\n');
+						throw format_error::FILE_WRITE_ERROR;
+					}
+					_written += static_cast<size_t>(written);
+
+					// Skip what was written, which may end within a vector.
+					size_t remaining = static_cast<size_t>(written);
+					while (first != vectors.size() && remaining >= vectors[first].iov_len) {
+						remaining -= vectors[first++].iov_len;
+					}
+					if (remaining != 0) {
+						vectors[first].iov_base = static_cast<char*>(vectors[first].iov_base) + remaining;
+						vectors[first].iov_len -= remaining;
+					}
+				}
+				return;
+			}
+#endif //EULERISTIC_JSON_POSIX_IO
+			for (auto text : texts) {
+				xsputn(text.data(), static_cast<std::streamsize>(text.size()));
+			}
+		}
+
+		// Writes what is left in the buffer and closes the file, moving it into place if it was a temporary one.
+		void _finish() {
+			_write_buffer();
+
+#ifdef EULERISTIC_JSON_POSIX_IO
+			// Space reserved past the end of the output is given back.
+			if (_preallocated && ::ftruncate(_file, static_cast<off_t>(_written)) != 0) {
+				PUSH_TO_COUT("Could not write to file: " << _path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+			if (_path != _target && ::fsync(_file) != 0) {
+				PUSH_TO_COUT("Could not write to file: " << _path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+			const int result = ::close(_file);
+			_file = -1;
+			if (result != 0) {
+				PUSH_TO_COUT("Could not write to file: " << _path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+#else //EULERISTIC_JSON_POSIX_IO
+			_file.close();
+			if (!_file) {
+				PUSH_TO_COUT("Could not write to file: " << _path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+#endif //EULERISTIC_JSON_POSIX_IO
+
+			if (_path != _target) {
+				std::error_code ec;
+				std::filesystem::rename(_path, _target, ec);
+				if (ec) {
+					PUSH_TO_COUT("Could not move " << _path << " to " << _target << ": " << ec.message() << '\n');
+					throw format_error::FILE_WRITE_ERROR;
+				}
+			}
+			_finished = true;
+		}
+	};
+
+	// Writes a JSON value to the file at path, through a large buffer.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void write_to_file(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path) {
+		write_to_file(value, path, write_options{});
+	};
+
+	// Writes a JSON value to the file at path, as options asks.
+	// If the extension of path is that of a compiled in compression format, the output is instead compressed on a separate thread as it is written, and options are ignored.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void write_to_file(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path, const write_options& options) {
 
 		PUSH_TO_COUT("Writing to file: " << path << '\n');
-		std::ofstream file(path);
-		file << value;
+
+#if defined(EULERISTIC_JSON_ZLIB) || defined(EULERISTIC_JSON_ZSTD)
+		if (auto codec = _compression::_codec_of(path)) {
+			_compression::_compressing_streambuf buffer(path, *codec);
+			std::ostream stream(&buffer);
+			stream << value;
+			if (!stream) {
+				buffer._finish();
+				PUSH_TO_COUT("Could not write to file: " << path << '\n');
+				throw format_error::FILE_WRITE_ERROR;
+			}
+			buffer._finish();
+			PUSH_TO_COUT("Successfully wrote to file!\n");
+			return;
+		}
+#endif //EULERISTIC_JSON_ZLIB || EULERISTIC_JSON_ZSTD
+
+		_buffered_file buffer(path, options);
+		std::ostream stream(&buffer);
+		stream << value;
+
+		// The stream catches what the buffer throws, and only remembers that it failed.
+		if (!stream) {
+			PUSH_TO_COUT("Could not write to file: " << path << '\n');
+			throw format_error::FILE_WRITE_ERROR;
+		}
+		buffer._finish();
 
 		PUSH_TO_COUT("Successfully wrote to file!\n");
 	};
@@ -1143,6 +3265,3995 @@ namespace euleristic::json {
 		value._write_to_ostream(stream);
 		return stream;
 	};
-}
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	class _msgpack {
+
+		// Appends the value to output, most significant byte first.
+		template <std::unsigned_integral uint_type>
+		static void _write_big_endian(std::vector<uint8_t>& output, const uint_type value) {
+			for (size_t shift = sizeof(uint_type) * 8; shift != 0; shift -= 8) {
+				output.push_back(static_cast<uint8_t>(value >> (shift - 8)));
+			}
+		}
+
+		// Reads a value stored most significant byte first and moves cursor past it.
+		template <std::unsigned_integral uint_type>
+		static uint_type _read_big_endian(const uint8_t*& cursor, const uint8_t* end) {
+			if (static_cast<size_t>(end - cursor) < sizeof(uint_type)) {
+				PUSH_TO_COUT("MessagePack source ended unexpectedly.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+			uint_type value = 0;
+			for (size_t i = 0; i < sizeof(uint_type); ++i) {
+				value = static_cast<uint_type>((static_cast<uint64_t>(value) << 8) | *cursor++);
+			}
+			return value;
+		}
+
+		// Writes the header of a string, array or map of size elements, using the fixed format if size is below fix_limit.
+		static void _write_header(std::vector<uint8_t>& output, const size_t size, const uint8_t fix_tag, const size_t fix_limit,
+			const std::optional<uint8_t> tag_8, const uint8_t tag_16, const uint8_t tag_32) {
+			if (size < fix_limit) {
+				output.push_back(static_cast<uint8_t>(fix_tag | size));
+			}
+			else if (tag_8 && size <= std::numeric_limits<uint8_t>::max()) {
+				output.push_back(*tag_8);
+				_write_big_endian(output, static_cast<uint8_t>(size));
+			}
+			else if (size <= std::numeric_limits<uint16_t>::max()) {
+				output.push_back(tag_16);
+				_write_big_endian(output, static_cast<uint16_t>(size));
+			}
+			else if (size <= std::numeric_limits<uint32_t>::max()) {
+				output.push_back(tag_32);
+				_write_big_endian(output, static_cast<uint32_t>(size));
+			}
+			else {
+				throw format_error::CONVERSION_FAILURE;
+			}
+		}
+
+		// Writes UTF-8 text as a MessagePack str.
+		static void _write_string(std::vector<uint8_t>& output, const std::string_view text) {
+			_write_header(output, text.size(), 0xa0, 32, 0xd9, 0xda, 0xdb);
+			output.insert(output.end(), text.cbegin(), text.cend());
+		}
+
+		// Writes the value to output as MessagePack.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static void _encode(const value_type<integer_type, floating_point_type, string_type>& value, std::vector<uint8_t>& output) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			switch (value._type) {
+			case json_value::_type_t::ARRAY: {
+				auto& arr = value._array();
+				_write_header(output, arr.size(), 0x90, 16, {}, 0xdc, 0xdd);
+				for (auto& element : arr) {
+					_encode(element, output);
+				}
+				return;
+			}
+
+			case json_value::_type_t::OBJECT: {
+				auto& obj = value._object();
+				_write_header(output, obj.size(), 0x80, 16, {}, 0xde, 0xdf);
+				for (auto& [key, element] : obj) {
+					_write_string(output, _string_handler::_narrow<string_type>(key));
+					_encode(element, output);
+				}
+				return;
+			}
+
+			case json_value::_type_t::STRING: {
+				auto& str = std::get<string_type>(*value._value);
+				if constexpr (std::is_same_v<string_type, std::string>) {
+					_write_string(output, str);
+				}
+				else {
+					_write_string(output, _string_handler::_narrow<string_type>(str));
+				}
+				return;
+			}
+
+			case json_value::_type_t::INTEGER: {
+				const integer_type n = std::get<integer_type>(*value._value);
+				if constexpr (std::is_signed_v<integer_type>) {
+					if (n < 0) {
+						const int64_t signed_n = n;
+						if (signed_n >= -32) {
+							output.push_back(static_cast<uint8_t>(signed_n));
+						}
+						else if (signed_n >= std::numeric_limits<int8_t>::min()) {
+							output.push_back(0xd0);
+							_write_big_endian(output, static_cast<uint8_t>(signed_n));
+						}
+						else if (signed_n >= std::numeric_limits<int16_t>::min()) {
+							output.push_back(0xd1);
+							_write_big_endian(output, static_cast<uint16_t>(signed_n));
+						}
+						else if (signed_n >= std::numeric_limits<int32_t>::min()) {
+							output.push_back(0xd2);
+							_write_big_endian(output, static_cast<uint32_t>(signed_n));
+						}
+						else {
+							output.push_back(0xd3);
+							_write_big_endian(output, static_cast<uint64_t>(signed_n));
+						}
+						return;
+					}
+				}
+				const uint64_t unsigned_n = static_cast<uint64_t>(n);
+				if (unsigned_n <= 0x7f) {
+					output.push_back(static_cast<uint8_t>(unsigned_n));
+				}
+				else if (unsigned_n <= std::numeric_limits<uint8_t>::max()) {
+					output.push_back(0xcc);
+					_write_big_endian(output, static_cast<uint8_t>(unsigned_n));
+				}
+				else if (unsigned_n <= std::numeric_limits<uint16_t>::max()) {
+					output.push_back(0xcd);
+					_write_big_endian(output, static_cast<uint16_t>(unsigned_n));
+				}
+				else if (unsigned_n <= std::numeric_limits<uint32_t>::max()) {
+					output.push_back(0xce);
+					_write_big_endian(output, static_cast<uint32_t>(unsigned_n));
+				}
+				else {
+					output.push_back(0xcf);
+					_write_big_endian(output, unsigned_n);
+				}
+				return;
+			}
+
+			case json_value::_type_t::FLOATING_POINT: {
+				const floating_point_type f = std::get<floating_point_type>(*value._value);
+				if constexpr (sizeof(floating_point_type) <= sizeof(float)) {
+					output.push_back(0xca);
+					_write_big_endian(output, std::bit_cast<uint32_t>(static_cast<float>(f)));
+				}
+				else {
+					output.push_back(0xcb);
+					_write_big_endian(output, std::bit_cast<uint64_t>(static_cast<double>(f)));
+				}
+				return;
+			}
+
+			case json_value::_type_t::BOOLEAN:
+				output.push_back(std::get<bool>(*value._value) ? 0xc3 : 0xc2);
+				return;
+
+			case json_value::_type_t::NULL_VALUE:
+				output.push_back(0xc0);
+				return;
+			}
+		}
+
+		// Converts a decoded MessagePack integer to integer_type, mirroring the range checks of the JSON parser.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static value_type<integer_type, floating_point_type, string_type> _make_integer(const std::integral auto n) {
+			if (!std::in_range<integer_type>(n)) {
+				PUSH_TO_COUT("MessagePack integer " << n << " was out of range for integer_type.\n");
+				throw parsing_error{ parsing_error::type_t::INTEGER_TYPE_TOO_NARROW, {}, {} };
+			}
+			value_type<integer_type, floating_point_type, string_type> value;
+			value._type = value_type<integer_type, floating_point_type, string_type>::_type_t::INTEGER;
+			value._value = static_cast<integer_type>(n);
+			return value;
+		}
+
+		// Converts a decoded MessagePack float to floating_point_type, mirroring the range checks of the JSON parser.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static value_type<integer_type, floating_point_type, string_type> _make_floating_point(const double f) {
+			// JSON has no numbers which are not finite.
+			if (!std::isfinite(f)) {
+				PUSH_TO_COUT("MessagePack float " << f << " was not finite.\n");
+				throw parsing_error{ parsing_error::type_t::INCORRECT_NUMBER_FORMAT, {}, {} };
+			}
+			// As when parsing text, a number which overflows, or underflows to below the normal range, is out of range.
+			const auto magnitude = std::abs(f);
+			if (magnitude > std::numeric_limits<floating_point_type>::max() || (f != 0.0 && std::abs(static_cast<floating_point_type>(f)) < std::numeric_limits<floating_point_type>::min())) {
+				PUSH_TO_COUT("MessagePack float " << f << " was out of range for floating_point_type.\n");
+				throw parsing_error{ parsing_error::type_t::FLOATING_POINT_TYPE_TOO_NARROW, {}, {} };
+			}
+			value_type<integer_type, floating_point_type, string_type> value;
+			value._type = value_type<integer_type, floating_point_type, string_type>::_type_t::FLOATING_POINT;
+			value._value = static_cast<floating_point_type>(f);
+			return value;
+		}
+
+		// Reads size bytes of UTF-8 at cursor as string_type, straight out of the source buffer.
+		template <string_concept string_type>
+		static string_type _read_string(const uint8_t*& cursor, const uint8_t* end, const size_t size) {
+			if (static_cast<size_t>(end - cursor) < size) {
+				PUSH_TO_COUT("MessagePack source ended unexpectedly within a string.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+			auto str = _string_handler::_widen<string_type>(std::string_view(reinterpret_cast<const char*>(cursor), size));
+			cursor += size;
+			return str;
+		}
+
+		// Reads the size of the str at cursor, whose tag has already been read.
+		static std::optional<size_t> _read_string_size(const uint8_t tag, const uint8_t*& cursor, const uint8_t* end) {
+			if ((tag & 0xe0) == 0xa0) return tag & 0x1f;
+			switch (tag) {
+			case 0xd9: return _read_big_endian<uint8_t>(cursor, end);
+			case 0xda: return _read_big_endian<uint16_t>(cursor, end);
+			case 0xdb: return _read_big_endian<uint32_t>(cursor, end);
+			default:   return {};
+			}
+		}
+
+		// The deepest nesting of arrays and maps decoded, since decoding recurses once per level.
+		static constexpr size_t _max_depth = 1024;
+
+		static void _check_depth(const size_t depth) {
+			if (depth > _max_depth) {
+				PUSH_TO_COUT("MessagePack arrays and maps were nested deeper than " << _max_depth << ".\n");
+				throw parsing_error{ parsing_error::type_t::LIMIT_EXCEEDED, {}, {} };
+			}
+		}
+
+		// Reads size elements at cursor as a JSON array, nested depth levels deep.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static value_type<integer_type, floating_point_type, string_type> _decode_array(const uint8_t*& cursor, const uint8_t* end, const size_t size, const size_t depth) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+			typename json_value::_array_alias arr;
+			_check_depth(depth);
+
+			// Every element takes at least one byte, so do not trust size further than that.
+			arr.reserve(std::min(size, static_cast<size_t>(end - cursor)));
+			for (size_t i = 0; i < size; ++i) {
+				arr.push_back(_decode<integer_type, floating_point_type, string_type>(cursor, end, depth));
+			}
+			json_value value;
+			value._hold(std::move(arr));
+			return value;
+		}
+
+		// Reads size key-value pairs at cursor as a JSON object, nested depth levels deep.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static value_type<integer_type, floating_point_type, string_type> _decode_object(const uint8_t*& cursor, const uint8_t* end, const size_t size, const size_t depth) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+			typename json_value::_object_alias obj;
+			_check_depth(depth);
+
+			// Every pair takes at least two bytes, so do not trust size further than that.
+			obj.reserve(std::min(size, static_cast<size_t>(end - cursor) / 2));
+			for (size_t i = 0; i < size; ++i) {
+				if (cursor == end) {
+					PUSH_TO_COUT("MessagePack source ended unexpectedly within a map.\n");
+					throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+				}
+				auto key_size = _read_string_size(*cursor++, cursor, end);
+				if (!key_size) {
+					PUSH_TO_COUT("MessagePack map key was not a string.\n");
+					throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+				}
+				auto key = _read_string<string_type>(cursor, end, *key_size);
+				obj.insert_or_assign(std::move(key), _decode<integer_type, floating_point_type, string_type>(cursor, end, depth));
+			}
+			json_value value;
+			value._hold(std::move(obj));
+			return value;
+		}
+
+		// Reads the MessagePack value at cursor, within depth levels of arrays and maps, and moves cursor past it.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static value_type<integer_type, floating_point_type, string_type> _decode(const uint8_t*& cursor, const uint8_t* end, const size_t depth = 0) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (cursor == end) {
+				PUSH_TO_COUT("MessagePack source ended unexpectedly.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+			const uint8_t tag = *cursor++;
+
+			// Fixed formats
+			if (tag <= 0x7f) return _make_integer<integer_type, floating_point_type, string_type>(tag);
+			if (tag >= 0xe0) return _make_integer<integer_type, floating_point_type, string_type>(static_cast<int8_t>(tag));
+			if ((tag & 0xf0) == 0x80) return _decode_object<integer_type, floating_point_type, string_type>(cursor, end, tag & 0x0f, depth + 1);
+			if ((tag & 0xf0) == 0x90) return _decode_array<integer_type, floating_point_type, string_type>(cursor, end, tag & 0x0f, depth + 1);
+			if (auto size = _read_string_size(tag, cursor, end)) {
+				return json_value(_read_string<string_type>(cursor, end, *size));
+			}
+
+			switch (tag) {
+			case 0xc0: return json_value(nullptr);
+			case 0xc2: return json_value(false);
+			case 0xc3: return json_value(true);
+			case 0xca: return _make_floating_point<integer_type, floating_point_type, string_type>(std::bit_cast<float>(_read_big_endian<uint32_t>(cursor, end)));
+			case 0xcb: return _make_floating_point<integer_type, floating_point_type, string_type>(std::bit_cast<double>(_read_big_endian<uint64_t>(cursor, end)));
+			case 0xcc: return _make_integer<integer_type, floating_point_type, string_type>(_read_big_endian<uint8_t>(cursor, end));
+			case 0xcd: return _make_integer<integer_type, floating_point_type, string_type>(_read_big_endian<uint16_t>(cursor, end));
+			case 0xce: return _make_integer<integer_type, floating_point_type, string_type>(_read_big_endian<uint32_t>(cursor, end));
+			case 0xcf: return _make_integer<integer_type, floating_point_type, string_type>(_read_big_endian<uint64_t>(cursor, end));
+			case 0xd0: return _make_integer<integer_type, floating_point_type, string_type>(static_cast<int8_t>(_read_big_endian<uint8_t>(cursor, end)));
+			case 0xd1: return _make_integer<integer_type, floating_point_type, string_type>(static_cast<int16_t>(_read_big_endian<uint16_t>(cursor, end)));
+			case 0xd2: return _make_integer<integer_type, floating_point_type, string_type>(static_cast<int32_t>(_read_big_endian<uint32_t>(cursor, end)));
+			case 0xd3: return _make_integer<integer_type, floating_point_type, string_type>(static_cast<int64_t>(_read_big_endian<uint64_t>(cursor, end)));
+			case 0xdc: return _decode_array<integer_type, floating_point_type, string_type>(cursor, end, _read_big_endian<uint16_t>(cursor, end), depth + 1);
+			case 0xdd: return _decode_array<integer_type, floating_point_type, string_type>(cursor, end, _read_big_endian<uint32_t>(cursor, end), depth + 1);
+			case 0xde: return _decode_object<integer_type, floating_point_type, string_type>(cursor, end, _read_big_endian<uint16_t>(cursor, end), depth + 1);
+			case 0xdf: return _decode_object<integer_type, floating_point_type, string_type>(cursor, end, _read_big_endian<uint32_t>(cursor, end), depth + 1);
+			default:
+				// bin, ext and the never used 0xc1 have no JSON equivalent.
+				PUSH_TO_COUT("MessagePack type 0x" << std::hex << static_cast<int>(tag) << std::dec << " has no JSON equivalent.\n");
+				throw parsing_error{ parsing_error::type_t::UNKNOWN_TOKEN, {}, {} };
+			}
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_msgpack(const std::span<const uint8_t>);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend std::vector<uint8_t> to_msgpack(const value_type<I, F, S>&);
+	};
+
+	// Parses MessagePack source. Numbers are subject to the same range checks as when parsing JSON text.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_msgpack(const std::span<const uint8_t> source) {
+
+		if (source.empty()) {
+			PUSH_TO_COUT("Source was empty!\n");
+			throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+		}
+
+		const uint8_t* cursor = source.data();
+		const uint8_t* end = source.data() + source.size();
+		auto value = _msgpack::_decode<integer_type, floating_point_type, string_type>(cursor, end);
+
+		if (cursor != end) {
+			PUSH_TO_COUT("Unexpected byte at offset " << cursor - source.data() << ", the source already had a value but continued.\n");
+			throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+		}
+
+		PUSH_TO_COUT("Source was successfully parsed.\n");
+
+		return value;
+	};
+
+	// Writes a JSON value as MessagePack.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] std::vector<uint8_t> to_msgpack(const value_type<integer_type, floating_point_type, string_type>& value) {
+		std::vector<uint8_t> output;
+		_msgpack::_encode(value, output);
+		return output;
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	// Writes JSON Canonicalization Scheme (RFC 8785) output: no whitespace, members sorted by the UTF-16 code units of their keys, and numbers formatted as ECMAScript does.
+	class _canonical {
+
+		// Orders code points as their UTF-16 encodings would be ordered, which only differs from code point order in that the
+		// surrogates of code points above U+FFFF come before U+E000 to U+FFFF.
+		static bool _utf16_less(const uint32_t lhs, const uint32_t rhs) {
+			auto rank = [](const uint32_t code_point) {
+				return code_point >= 0x10000 ? 0xD800 + ((code_point - 0x10000) >> 10) : code_point;
+			};
+			const uint32_t lhs_rank = rank(lhs);
+			const uint32_t rhs_rank = rank(rhs);
+			return lhs_rank != rhs_rank ? lhs_rank < rhs_rank : lhs < rhs;
+		}
+
+		// Decodes the UTF-8 code point which contains index.
+		static uint32_t _code_point_at(const std::string_view text, size_t index) {
+			while (index != 0 && (static_cast<uint8_t>(text[index]) & 0xC0) == 0x80) {
+				--index;
+			}
+			const uint8_t lead = static_cast<uint8_t>(text[index]);
+			const size_t length = lead < 0x80 ? 1 : lead < 0xE0 ? 2 : lead < 0xF0 ? 3 : 4;
+			uint32_t code_point = length == 1 ? lead : lead & (0x7F >> length);
+			for (size_t i = 1; i < length && index + i < text.size(); ++i) {
+				code_point = (code_point << 6) | (static_cast<uint8_t>(text[index + i]) & 0x3F);
+			}
+			return code_point;
+		}
+
+		// Compares keys by their UTF-16 code units. UTF-8 and UTF-32 already sort by code point, so only the first difference needs a closer look.
+		template <typename char_t>
+		static bool _key_less(const std::basic_string_view<char_t> lhs, const std::basic_string_view<char_t> rhs) {
+			const auto [lhs_it, rhs_it] = std::mismatch(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+			if (lhs_it == lhs.end() || rhs_it == rhs.end()) {
+				return lhs_it == lhs.end() && rhs_it != rhs.end();
+			}
+			if constexpr (sizeof(char_t) == 1) {
+				return _utf16_less(_code_point_at(lhs, lhs_it - lhs.begin()), _code_point_at(rhs, rhs_it - rhs.begin()));
+			}
+			else if constexpr (sizeof(char_t) == 2) {
+				return static_cast<uint16_t>(*lhs_it) < static_cast<uint16_t>(*rhs_it);
+			}
+			else {
+				return _utf16_less(static_cast<uint32_t>(*lhs_it), static_cast<uint32_t>(*rhs_it));
+			}
+		}
+
+		// Writes UTF-8 text as a JSON string, escaping only what must be escaped.
+		static void _write_string(const std::string_view text, std::string& output) {
+			static constexpr char hex[] = "0123456789abcdef";
+			output.push_back('\"');
+			auto run = text.begin();
+			for (auto it = text.begin(); it != text.end(); ++it) {
+				const uint8_t c = static_cast<uint8_t>(*it);
+				if (c >= 0x20 && c != '\"' && c != '\\') {
+					continue;
+				}
+				output.append(run, it);
+				run = std::next(it);
+				output.push_back('\\');
+				switch (c) {
+				case '\"': output.push_back('\"'); break;
+				case '\\': output.push_back('\\'); break;
+				case '\b': output.push_back('b'); break;
+				case '\f': output.push_back('f'); break;
+				case '\n': output.push_back('n'); break;
+				case '\r': output.push_back('r'); break;
+				case '\t': output.push_back('t'); break;
+				default:
+					output.append("u00");
+					output.push_back(hex[c >> 4]);
+					output.push_back(hex[c & 0xF]);
+				}
+			}
+			output.append(run, text.end());
+			output.push_back('\"');
+		}
+
+		template <string_concept string_type>
+		static void _write_string(const string_type& text, std::string& output) {
+			if constexpr (std::is_same_v<string_type, std::string>) {
+				_write_string(std::string_view(text), output);
+			}
+			else {
+				_write_string(_string_handler::_narrow<string_type>(text), output);
+			}
+		}
+
+		// Writes the number as ECMAScript's Number.prototype.toString would, from the shortest digits which round trip to value.
+		template <std::floating_point floating_point_type>
+		static void _write_number(const floating_point_type value, std::string& output) {
+			if (!std::isfinite(value)) {
+				throw format_error::CONVERSION_FAILURE;
+			}
+			if (value == 0) {
+				output.push_back('0');
+				return;
+			}
+
+			char buffer[64];
+			const auto end = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::scientific).ptr;
+			const std::string_view scientific(buffer, end - buffer);
+
+			// Split d.ddde±x into its digits and the exponent n, where value is 0.ddd * 10^n.
+			const size_t e = scientific.find('e');
+			const bool negative = scientific.front() == '-';
+			std::string digits;
+			for (char c : scientific.substr(negative, e - negative)) {
+				if (c != '.') digits.push_back(c);
+			}
+			int exponent = 0;
+			std::from_chars(scientific.data() + e + (scientific[e + 1] == '+' ? 2 : 1), scientific.data() + scientific.size(), exponent);
+			const int n = exponent + 1;
+			const int k = static_cast<int>(digits.size());
+
+			if (negative) {
+				output.push_back('-');
+			}
+			if (k <= n && n <= 21) {
+				output.append(digits);
+				output.append(static_cast<size_t>(n - k), '0');
+			}
+			else if (0 < n && n <= 21) {
+				output.append(digits, 0, static_cast<size_t>(n));
+				output.push_back('.');
+				output.append(digits, static_cast<size_t>(n));
+			}
+			else if (-6 < n && n <= 0) {
+				output.append("0.");
+				output.append(static_cast<size_t>(-n), '0');
+				output.append(digits);
+			}
+			else {
+				output.push_back(digits.front());
+				if (k > 1) {
+					output.push_back('.');
+					output.append(digits, 1);
+				}
+				output.push_back('e');
+				output.push_back(n - 1 < 0 ? '-' : '+');
+				output.append(std::to_string(std::abs(n - 1)));
+			}
+		}
+
+		// Integers are exact up to 2^53, past which ECMAScript only has the nearest double.
+		template <std::integral integer_type>
+		static void _write_integer(const integer_type value, std::string& output) {
+			constexpr integer_type exact = std::numeric_limits<integer_type>::digits > 53 ? integer_type(int64_t(1) << 53) : std::numeric_limits<integer_type>::max();
+			if (value <= exact && (std::is_unsigned_v<integer_type> || value >= -exact)) {
+				char buffer[32];
+				output.append(buffer, std::to_chars(buffer, buffer + sizeof(buffer), value).ptr);
+			}
+			else {
+				_write_number(static_cast<double>(value), output);
+			}
+		}
+
+		// Writes value to output. Members are sorted as pointers on the end of members, which is shared by the whole traversal.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static void _write(const value_type<integer_type, floating_point_type, string_type>& value, std::string& output,
+			std::vector<const typename value_type<integer_type, floating_point_type, string_type>::_object_alias::value_type*>& members) {
+
+			using value_t = value_type<integer_type, floating_point_type, string_type>;
+			switch (value._type) {
+			case value_t::_type_t::OBJECT: {
+				auto& object = value._object();
+				const size_t first = members.size();
+				for (auto& member : object) {
+					members.push_back(&member);
+				}
+				std::sort(members.begin() + first, members.end(), [](auto lhs, auto rhs) {
+					using char_t = typename string_type::value_type;
+					return _key_less<char_t>(lhs->first, rhs->first);
+				});
+				output.push_back('{');
+				for (size_t i = first; i != first + object.size(); ++i) {
+					if (i != first) {
+						output.push_back(',');
+					}
+					_write_string(members[i]->first, output);
+					output.push_back(':');
+					_write(members[i]->second, output, members);
+				}
+				output.push_back('}');
+				members.resize(first);
+				return;
+			}
+			case value_t::_type_t::ARRAY: {
+				auto& array = value._array();
+				output.push_back('[');
+				for (auto it = array.begin(); it != array.end(); ++it) {
+					if (it != array.begin()) {
+						output.push_back(',');
+					}
+					_write(*it, output, members);
+				}
+				output.push_back(']');
+				return;
+			}
+			case value_t::_type_t::STRING:
+				_write_string(std::get<string_type>(*value._value), output);
+				return;
+			case value_t::_type_t::INTEGER:
+				_write_integer(std::get<integer_type>(*value._value), output);
+				return;
+			case value_t::_type_t::FLOATING_POINT:
+				_write_number(std::get<floating_point_type>(*value._value), output);
+				return;
+			case value_t::_type_t::BOOLEAN:
+				output.append(std::get<bool>(*value._value) ? "true" : "false");
+				return;
+			case value_t::_type_t::NULL_VALUE:
+				output.append("null");
+				return;
+			}
+		}
+
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static std::string _write(const value_type<integer_type, floating_point_type, string_type>& value) {
+			std::string output;
+			std::vector<const typename value_type<integer_type, floating_point_type, string_type>::_object_alias::value_type*> members;
+			_write(value, output, members);
+			return output;
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend std::string to_canonical(const value_type<I, F, S>&);
+	};
+
+	// Writes a JSON value in the JSON Canonicalization Scheme (RFC 8785), which is the same for equal values regardless of the order of members.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] std::string to_canonical(const value_type<integer_type, floating_point_type, string_type>& value) {
+		return _canonical::_write(value);
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	// Hashes the structure of values in one traversal, without serializing them. Members are combined so that their order does not matter.
+	class _hasher {
+
+		// Seeds which keep values of different types, which may share bits, apart.
+		enum class _seed_t : uint64_t {
+			NULL_VALUE = 0x6a09e667f3bcc908, OBJECT = 0xbb67ae8584caa73b, ARRAY = 0x3c6ef372fe94f82b, INTEGER = 0xa54ff53a5f1d36f1,
+			FLOATING_POINT = 0x510e527fade682d1, STRING = 0x9b05688c2b3e6c1f, TRUE = 0x1f83d9abfb41bd6b, FALSE = 0x5be0cd19137e2179
+		};
+
+		// The finalizer of splitmix64, which spreads every bit of x over the whole result.
+		static uint64_t _mix(uint64_t x) {
+			x ^= x >> 30;
+			x *= 0xbf58476d1ce4e5b9;
+			x ^= x >> 27;
+			x *= 0x94d049bb133111eb;
+			x ^= x >> 31;
+			return x;
+		}
+
+		static uint64_t _combine(const uint64_t seed, const uint64_t value) {
+			return _mix(seed ^ (value + 0x9e3779b97f4a7c15 + (seed << 6) + (seed >> 2)));
+		}
+
+		// Hashes value, looking up and storing the hashes of containers in memo, if given.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static uint64_t _hash(const value_type<integer_type, floating_point_type, string_type>& value, std::unordered_map<const void*, uint64_t>* memo) {
+			using value_t = value_type<integer_type, floating_point_type, string_type>;
+			using char_t = typename string_type::value_type;
+
+			switch (value._type) {
+			case value_t::_type_t::OBJECT: {
+				auto& object = value._object();
+				if (memo) {
+					if (auto it = memo->find(&object); it != memo->end()) {
+						return it->second;
+					}
+				}
+
+				// Summing the hashes of the members makes the order of the members irrelevant.
+				uint64_t sum = 0;
+				for (auto& [key, element] : object) {
+					sum += _combine(std::hash<std::basic_string_view<char_t>>{}(key), _hash(element, memo));
+				}
+				const uint64_t hash = _combine(static_cast<uint64_t>(_seed_t::OBJECT) ^ object.size(), sum);
+				if (memo) {
+					memo->emplace(&object, hash);
+				}
+				return hash;
+			}
+			case value_t::_type_t::ARRAY: {
+				auto& array = value._array();
+				if (memo) {
+					if (auto it = memo->find(&array); it != memo->end()) {
+						return it->second;
+					}
+				}
+
+				uint64_t hash = static_cast<uint64_t>(_seed_t::ARRAY) ^ array.size();
+				for (auto& element : array) {
+					hash = _combine(hash, _hash(element, memo));
+				}
+				if (memo) {
+					memo->emplace(&array, hash);
+				}
+				return hash;
+			}
+			case value_t::_type_t::STRING:
+				return _combine(static_cast<uint64_t>(_seed_t::STRING), std::hash<std::basic_string_view<char_t>>{}(std::get<string_type>(*value._value)));
+			case value_t::_type_t::INTEGER:
+				return _combine(static_cast<uint64_t>(_seed_t::INTEGER), static_cast<uint64_t>(std::get<integer_type>(*value._value)));
+			case value_t::_type_t::FLOATING_POINT: {
+				// Zeros compare equal regardless of their sign, so they must hash equal too.
+				const auto number = std::get<floating_point_type>(*value._value);
+				return _combine(static_cast<uint64_t>(_seed_t::FLOATING_POINT), std::hash<floating_point_type>{}(number == 0 ? floating_point_type(0) : number));
+			}
+			case value_t::_type_t::BOOLEAN:
+				return _mix(static_cast<uint64_t>(std::get<bool>(*value._value) ? _seed_t::TRUE : _seed_t::FALSE));
+			case value_t::_type_t::NULL_VALUE:
+				return _mix(static_cast<uint64_t>(_seed_t::NULL_VALUE));
+			}
+			return 0;
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend size_t hash(const value_type<I, F, S>&);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class hash_memo;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class json_patch;
+		friend class _deduplicator;
+	};
+
+	// Hashes the structure of value, such that equal values hash equal regardless of the order of their members.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] size_t hash(const value_type<integer_type, floating_point_type, string_type>& value) {
+		return static_cast<size_t>(_hasher::_hash(value, nullptr));
+	};
+
+	// Hashes values as hash does, but remembers the hash of every array and object it has hashed, by address,
+	// so that hashing a value again, or a value which contains it, does not traverse it again.
+	// Only valid as long as the hashed values are neither modified nor destroyed; clear() forgets every remembered hash.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	class hash_memo {
+		std::unordered_map<const void*, uint64_t> _hashes;
+
+	public:
+		[[nodiscard]] size_t hash(const value_type<integer_type, floating_point_type, string_type>& value) {
+			return static_cast<size_t>(_hasher::_hash(value, &_hashes));
+		}
+
+		void clear() {
+			_hashes.clear();
+		}
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to.
+	// Shares identical arrays and objects within a value, so that each is held only once.
+	class _deduplicator {
+
+		// The bytes which are freed when value is destroyed: those of its string, or those of its array or object and everything in it,
+		// unless it is shared with other values. An estimate, since the overhead of each allocation is not known.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static size_t _freed(const value_type<integer_type, floating_point_type, string_type>& value) {
+			size_t allocations = 0;
+			size_t bytes = 0;
+			value._account(allocations, bytes, nullptr, true);
+			return bytes;
+		}
+
+		// What a pass over root keeps: the path from root to the value visited, as indices and keys, the hashes of arrays and objects
+		// by address, those visited and not replaced by hash, the replaced values, which are kept so that the addresses memo knows
+		// the hashes of are not reused during the pass, and the bytes of the shared arrays and objects copied on the way to replacements.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		struct _pass {
+			using value_t = value_type<integer_type, floating_point_type, string_type>;
+
+			value_t& _root;
+			std::vector<std::variant<size_t, const string_type*>> _path;
+			std::unordered_map<const void*, uint64_t> _memo;
+			std::unordered_multimap<uint64_t, value_t*> _canonical;
+			std::vector<value_t> _replaced;
+			size_t _copied = 0;
+
+			explicit _pass(value_t& root) : _root(root) {}
+		};
+
+		// The value at the end of the path of pass, for modification. Only the arrays and objects on the path are taken for modification,
+		// and the bytes of those which were shared, and so are copied, are added to those pass has copied.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static value_type<integer_type, floating_point_type, string_type>& _reach(_pass<integer_type, floating_point_type, string_type>& pass) {
+			auto* value = &pass._root;
+			for (auto& step : pass._path) {
+				const bool shared = value->_shared();
+				auto* next = std::holds_alternative<size_t>(step) ? &value->_mutable_array()[std::get<size_t>(step)]
+					: &value->_mutable_object().find(*std::get<const string_type*>(step))->second;
+				if (shared) {
+					pass._copied += _freed(*value);
+				}
+				value = next;
+			}
+			return *value;
+		}
+
+		// Replaces value, which is at the end of the path of pass, with an equal array or object in canonical, if there is one, and otherwise
+		// adds it to canonical and goes on to its elements, so that the largest identical subtrees are shared. The walk itself does not modify
+		// anything, so that arrays and objects shared with copies, or within the value, are only copied on the way to a replacement.
+		// Returns the bytes freed by the replacements.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static size_t _deduplicate(const value_type<integer_type, floating_point_type, string_type>& value, _pass<integer_type, floating_point_type, string_type>& pass) {
+			using value_t = value_type<integer_type, floating_point_type, string_type>;
+
+			if (value._type != value_t::_type_t::ARRAY && value._type != value_t::_type_t::OBJECT) {
+				return 0;
+			}
+
+			const uint64_t hash = _hasher::_hash(value, &pass._memo);
+			for (auto [it, end] = pass._canonical.equal_range(hash); it != end; ++it) {
+				if (*it->second == value) {
+					// A value which already shares the array or object of its equal, as after an earlier pass, is left as it is.
+					if (value._type == value_t::_type_t::ARRAY ? &it->second->_array() == &value._array() : &it->second->_object() == &value._object()) {
+						return 0;
+					}
+					auto& replaced = _reach(pass);
+					const size_t freed = _freed(replaced);
+					pass._replaced.push_back(std::move(replaced));
+					replaced._share(*it->second);
+					return freed;
+				}
+			}
+			// The value is within root, which is not const, so the canonical value may be modified when it is shared.
+			pass._canonical.emplace(hash, const_cast<value_t*>(&value));
+
+			// Taking the array or object of value for modification on the way to a replacement may move it within value, which leaves
+			// its elements where they are, and iterators to them valid, but not references to the container, so it is fetched again.
+			size_t freed = 0;
+			if (value._type == value_t::_type_t::ARRAY) {
+				for (size_t index = 0; index < value._array().size(); ++index) {
+					pass._path.emplace_back(index);
+					freed += _deduplicate(value._array()[index], pass);
+					pass._path.pop_back();
+				}
+			}
+			else {
+				for (auto member = value._object().begin(), end = value._object().end(); member != end; ++member) {
+					pass._path.emplace_back(&member->first);
+					freed += _deduplicate(member->second, pass);
+					pass._path.pop_back();
+				}
+			}
+			return freed;
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend size_t deduplicate(value_type<I, F, S>&);
+	};
+
+	// Makes identical arrays and objects within value share one copy, and returns an estimate of the bytes this freed, less those of the arrays
+	// and objects shared with copies which it copied on the way to those it replaced. Only those are copied; copies of value are unaffected,
+	// and copies made later only keep the sharing with EULERISTIC_JSON_COPY_ON_WRITE. Costs a hash of every array and object, and a comparison of each with those of equal hash.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	size_t deduplicate(value_type<integer_type, floating_point_type, string_type>& value) {
+		_deduplicator::_pass<integer_type, floating_point_type, string_type> pass(value);
+		const size_t freed = _deduplicator::_deduplicate(std::as_const(value), pass);
+		return freed > pass._copied ? freed - pass._copied : 0;
+	};
+
+	// A JSON Pointer (RFC 6901), which is parsed once and may then be resolved against any number of values.
+	template <string_concept string_type>
+	class json_pointer {
+		using _char_alias = typename string_type::value_type;
+
+		// A reference token, with its array index parsed in advance, if it is one.
+		struct _token {
+			string_type _key;
+			std::optional<size_t> _index;
+		};
+
+		std::vector<_token> _tokens;
+
+		// Friends
+		template <string_concept S>
+		friend class projection;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class json_patch;
+
+		// Resolves a single reference token against value, with at most one lookup.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		static const value_type<integer_type, floating_point_type, string_type>* _step(
+			const value_type<integer_type, floating_point_type, string_type>& value, const _token& token) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			switch (value._type) {
+			case json_value::_type_t::OBJECT: {
+				auto& obj = value._object();
+				auto it = obj.find(token._key);
+				return it != obj.end() ? &it->second : nullptr;
+			}
+			case json_value::_type_t::ARRAY: {
+				auto& arr = value._array();
+				return token._index && *token._index < arr.size() ? &arr[*token._index] : nullptr;
+			}
+			default:
+				return nullptr;
+			}
+		}
+
+	public:
+		// The pointer to the whole document, "".
+		json_pointer() = default;
+
+		// Parses the pointer, e.g. "/a/b/3/c". Throws parsing_error if it is not a valid JSON Pointer.
+		json_pointer(const std::basic_string_view<_char_alias> text) {
+			if (text.empty()) {
+				return;
+			}
+			if (text.front() != '/') {
+				PUSH_TO_COUT("JSON Pointer did not begin with '/'.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, 1, 1 };
+			}
+
+			for (auto cursor = text.cbegin(); cursor != text.cend();) {
+				++cursor;
+				auto token_end = std::find(cursor, text.cend(), _char_alias('/'));
+
+				// Unescape "~1" to '/' and "~0" to '~'
+				string_type key;
+				key.reserve(token_end - cursor);
+				for (auto it = cursor; it != token_end; ++it) {
+					if (*it != '~') {
+						key.push_back(*it);
+						continue;
+					}
+					++it;
+					if (it == token_end || (*it != '0' && *it != '1')) {
+						PUSH_TO_COUT("JSON Pointer had a '~' which was not followed by '0' or '1'.\n");
+						throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, 1, static_cast<uint16_t>(it - text.cbegin() + 1) };
+					}
+					key.push_back(*it == '0' ? _char_alias('~') : _char_alias('/'));
+				}
+
+				// An array index is "0" or digits without a leading zero.
+				std::optional<size_t> index;
+				if (!key.empty() && (key.size() == 1 || key.front() != '0')
+					&& std::all_of(key.cbegin(), key.cend(), [](const _char_alias c) { return '0' <= c && c <= '9'; })) {
+					index = 0;
+					for (const _char_alias c : key) {
+						if (*index > (std::numeric_limits<size_t>::max() - 9) / 10) {
+							index.reset();
+							break;
+						}
+						*index = *index * 10 + static_cast<size_t>(c - '0');
+					}
+				}
+
+				_tokens.push_back({ std::move(key), index });
+				cursor = token_end;
+			}
+		}
+
+		// Parses the pointer, e.g. "/a/b/3/c". Throws parsing_error if it is not a valid JSON Pointer.
+		json_pointer(const _char_alias* text) : json_pointer(std::basic_string_view<_char_alias>(text)) {}
+
+		// Returns the pointer as JSON Pointer text.
+		[[nodiscard]] string_type to_string() const {
+			string_type text;
+			for (auto& token : _tokens) {
+				text.push_back('/');
+				for (const _char_alias c : token._key) {
+					if (c == '~') {
+						text.push_back('~');
+						text.push_back('0');
+					}
+					else if (c == '/') {
+						text.push_back('~');
+						text.push_back('1');
+					}
+					else {
+						text.push_back(c);
+					}
+				}
+			}
+			return text;
+		}
+
+		// Returns how many reference tokens the pointer consists of.
+		[[nodiscard]] size_t size() const {
+			return _tokens.size();
+		}
+
+		// Returns the value the pointer refers to within root, or nullptr if there is no such value.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		[[nodiscard]] const value_type<integer_type, floating_point_type, string_type>* resolve(
+			const value_type<integer_type, floating_point_type, string_type>& root) const {
+			const value_type<integer_type, floating_point_type, string_type>* value = &root;
+			for (auto it = _tokens.cbegin(); value && it != _tokens.cend(); ++it) {
+				value = _step(*value, *it);
+			}
+			return value;
+		}
+
+		// Resolves all pointers against root in one pass, so that pointers which share a prefix only resolve it once.
+		// Returns the values in the order of pointers, with nullptr for those which refer to no value.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		[[nodiscard]] static std::vector<const value_type<integer_type, floating_point_type, string_type>*> resolve_all(
+			const value_type<integer_type, floating_point_type, string_type>& root, const std::span<const json_pointer> pointers) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			// Visit the pointers in lexicographical order, so that shared prefixes are adjacent.
+			std::vector<size_t> order(pointers.size());
+			std::iota(order.begin(), order.end(), size_t(0));
+			std::sort(order.begin(), order.end(), [&pointers](const size_t lhs, const size_t rhs) {
+				return std::lexicographical_compare(
+					pointers[lhs]._tokens.cbegin(), pointers[lhs]._tokens.cend(),
+					pointers[rhs]._tokens.cbegin(), pointers[rhs]._tokens.cend(),
+					[](const _token& lhs, const _token& rhs) { return lhs._key < rhs._key; });
+			});
+
+			// path[i] is the value after resolving the first i tokens of the previous pointer, as far as they resolved.
+			std::vector<const json_value*> results(pointers.size(), nullptr);
+			std::vector<const json_value*> path{ &root };
+			const json_pointer* previous = nullptr;
+			for (const size_t i : order) {
+				auto& tokens = pointers[i]._tokens;
+				size_t shared = 0;
+				if (previous) {
+					auto mismatch = std::mismatch(tokens.cbegin(), tokens.cend(), previous->_tokens.cbegin(), previous->_tokens.cend(),
+						[](const _token& lhs, const _token& rhs) { return lhs._key == rhs._key; });
+					shared = mismatch.first - tokens.cbegin();
+				}
+				path.resize(std::min(path.size(), shared + 1));
+				while (path.size() <= tokens.size()) {
+					auto next = _step(*path.back(), tokens[path.size() - 1]);
+					if (!next) {
+						break;
+					}
+					path.push_back(next);
+				}
+				if (path.size() == tokens.size() + 1) {
+					results[i] = path.back();
+				}
+				previous = &pointers[i];
+			}
+			return results;
+		}
+	};
+
+	// A JSON Patch (RFC 6902), which is parsed once and may then be applied to any number of values.
+	// Operations are applied in place, moving values rather than copying them, and a patch which fails part way is undone before apply throws.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	class json_patch {
+		using _json_value = value_type<integer_type, floating_point_type, string_type>;
+		using _pointer_alias = json_pointer<string_type>;
+
+		struct _operation {
+			enum class _type_t {
+				ADD,
+				REMOVE,
+				REPLACE,
+				MOVE,
+				COPY,
+				TEST
+			} _type;
+			_pointer_alias _path;
+			_pointer_alias _from;
+			_json_value _value;
+		};
+
+		// Undoes a change to the value at the last token of _path. Undoing a removal inserts _old, or, if _stashed,
+		// whatever the previous undo took out, which is how moved values are moved back. Undoing an addition or a replacement takes the value out.
+		struct _undo {
+			enum class _type_t {
+				ERASE,
+				INSERT,
+				ASSIGN
+			} _type;
+			const _pointer_alias* _path;
+			size_t _index;
+			_json_value _old;
+			bool _stashed = false;
+		};
+
+		std::vector<_operation> _operations;
+
+		// Returns the value at path, without its last token if parent, for modification. Throws interface_misuse if there is no such value.
+		static _json_value& _resolve(_json_value& root, const _pointer_alias& path, const bool parent) {
+			_json_value* value = &root;
+			const size_t size = path._tokens.size() - (parent ? 1 : 0);
+			for (size_t i = 0; i < size; ++i) {
+				auto& token = path._tokens[i];
+				if (value->_type == _json_value::_type_t::OBJECT) {
+					if (!value->_object().contains(token._key)) {
+						throw interface_misuse::NO_SUCH_KEY;
+					}
+					value = &value->_mutable_object().find(token._key)->second;
+				}
+				else if (value->_type == _json_value::_type_t::ARRAY) {
+					if (!token._index || *token._index >= value->_array().size()) {
+						throw interface_misuse::INDEX_OUT_OF_RANGE;
+					}
+					value = &value->_mutable_array()[*token._index];
+				}
+				else {
+					throw interface_misuse::INCORRECT_TYPE;
+				}
+			}
+			return *value;
+		}
+
+		// Returns the index the last token of path refers to within array, where "-" is one past the end.
+		static size_t _index(const _json_value& array, const _pointer_alias& path, const bool past_end) {
+			auto& token = path._tokens.back();
+			if (past_end && token._key.size() == 1 && token._key.front() == '-') {
+				return array._array().size();
+			}
+			if (!token._index || *token._index > array._array().size() || (!past_end && *token._index == array._array().size())) {
+				throw interface_misuse::INDEX_OUT_OF_RANGE;
+			}
+			return *token._index;
+		}
+
+		// Adds value at path. It is only moved from once the path has resolved, so if this throws, value is as it was.
+		static void _add(_json_value& root, const _pointer_alias& path, _json_value&& value, std::vector<_undo>& log, const bool stashed) {
+			if (path._tokens.empty()) {
+				log.push_back({ _undo::_type_t::ASSIGN, &path, 0, std::move(root), stashed });
+				root = std::move(value);
+				return;
+			}
+			auto& parent = _resolve(root, path, true);
+			auto& key = path._tokens.back()._key;
+			if (parent._type == _json_value::_type_t::OBJECT) {
+				auto& obj = parent._mutable_object();
+				auto it = obj.find(key);
+				if (it != obj.end()) {
+					log.push_back({ _undo::_type_t::ASSIGN, &path, 0, std::move(it->second), stashed });
+					it->second = std::move(value);
+				}
+				else {
+					obj.emplace(key, std::move(value));
+					log.push_back({ _undo::_type_t::ERASE, &path, 0, {}, stashed });
+				}
+			}
+			else if (parent._type == _json_value::_type_t::ARRAY) {
+				const size_t index = _index(parent, path, true);
+				auto& arr = parent._mutable_array();
+				arr.insert(arr.begin() + index, std::move(value));
+				log.push_back({ _undo::_type_t::ERASE, &path, index, {}, stashed });
+			}
+			else {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+		}
+
+		// Removes and returns the value at path. If moved, the value is expected to be added elsewhere, and the undo takes it back from there.
+		static _json_value _remove(_json_value& root, const _pointer_alias& path, std::vector<_undo>& log, const bool moved) {
+			if (path._tokens.empty()) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			auto& parent = _resolve(root, path, true);
+			_json_value value;
+			size_t index = 0;
+			if (parent._type == _json_value::_type_t::OBJECT) {
+				auto& key = path._tokens.back()._key;
+				if (!parent._object().contains(key)) {
+					throw interface_misuse::NO_SUCH_KEY;
+				}
+				auto& obj = parent._mutable_object();
+				auto it = obj.find(key);
+				value = std::move(it->second);
+				obj.erase(it);
+			}
+			else if (parent._type == _json_value::_type_t::ARRAY) {
+				index = _index(parent, path, false);
+				auto& arr = parent._mutable_array();
+				value = std::move(arr[index]);
+				arr.erase(arr.begin() + index);
+			}
+			else {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+
+			if (moved) {
+				log.push_back({ _undo::_type_t::INSERT, &path, index, {}, true });
+				return value;
+			}
+			log.push_back({ _undo::_type_t::INSERT, &path, index, std::move(value), false });
+			return {};
+		}
+
+		static void _replace(_json_value& root, const _pointer_alias& path, _json_value value, std::vector<_undo>& log) {
+			auto& target = _resolve(root, path, false);
+			const size_t index = path._tokens.empty() ? 0 : path._tokens.back()._index.value_or(0);
+			log.push_back({ _undo::_type_t::ASSIGN, &path, index, std::move(target), false });
+			target = std::move(value);
+		}
+
+		// Undoes the log, last change first.
+		static void _roll_back(_json_value& root, std::vector<_undo>& log) {
+			_json_value stash;
+			for (auto it = log.rbegin(); it != log.rend(); ++it) {
+				auto& path = *it->_path;
+				if (path._tokens.empty()) {
+					stash = std::move(root);
+					root = std::move(it->_old);
+					continue;
+				}
+				auto& parent = _resolve(root, path, true);
+				if (parent._type == _json_value::_type_t::OBJECT) {
+					auto& obj = parent._mutable_object();
+					auto& key = path._tokens.back()._key;
+					switch (it->_type) {
+					case _undo::_type_t::ERASE: {
+						auto member = obj.find(key);
+						stash = std::move(member->second);
+						obj.erase(member);
+						break;
+					}
+					case _undo::_type_t::INSERT:
+						obj.emplace(key, it->_stashed ? std::move(stash) : std::move(it->_old));
+						break;
+					case _undo::_type_t::ASSIGN: {
+						auto& member = obj.find(key)->second;
+						stash = std::move(member);
+						member = std::move(it->_old);
+						break;
+					}
+					}
+				}
+				else {
+					auto& arr = parent._mutable_array();
+					switch (it->_type) {
+					case _undo::_type_t::ERASE:
+						stash = std::move(arr[it->_index]);
+						arr.erase(arr.begin() + it->_index);
+						break;
+					case _undo::_type_t::INSERT:
+						arr.insert(arr.begin() + it->_index, it->_stashed ? std::move(stash) : std::move(it->_old));
+						break;
+					case _undo::_type_t::ASSIGN: {
+						auto& element = arr[it->_index];
+						stash = std::move(element);
+						element = std::move(it->_old);
+						break;
+					}
+					}
+				}
+			}
+		}
+
+		// Returns the member name of op, which must be a string, or nothing if there is no such member.
+		static const string_type* _string_member(const _json_value& op, const string_type& name) {
+			auto& obj = op._object();
+			auto it = obj.find(name);
+			if (it == obj.end()) {
+				return nullptr;
+			}
+			if (it->second._type != _json_value::_type_t::STRING) {
+				PUSH_TO_COUT("JSON Patch operation had a member which should have been a string, but was not.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+			}
+			return &std::get<string_type>(*it->second._value);
+		}
+
+		static string_type _name(const char* name) {
+			return string_type(name, name + std::strlen(name));
+		}
+
+		// Arrays whose changed middles would need an LCS table of more cells than this are instead diffed element by element.
+		static constexpr size_t _lcs_limit = size_t(1) << 24;
+
+		// Appends an operation at the path of tokens.
+		void _emit(const typename _operation::_type_t type, const std::vector<typename _pointer_alias::_token>& tokens, _json_value value = {}) {
+			_operation operation{ type, {}, {}, std::move(value) };
+			operation._path._tokens = tokens;
+			_operations.push_back(std::move(operation));
+		}
+
+		static typename _pointer_alias::_token _index_token(const size_t index) {
+			const std::string digits = std::to_string(index);
+			return { string_type(digits.begin(), digits.end()), index };
+		}
+
+		// Whether from and to are equal, which shared containers and differing hashes tell without comparing them.
+		static bool _same(const _json_value& from, const _json_value& to, std::unordered_map<const void*, uint64_t>& hashes) {
+			if (from._type != to._type) {
+				return false;
+			}
+			if (from._type == _json_value::_type_t::ARRAY && &from._array() == &to._array()) {
+				return true;
+			}
+			if (from._type == _json_value::_type_t::OBJECT && &from._object() == &to._object()) {
+				return true;
+			}
+			return _hasher::_hash(from, &hashes) == _hasher::_hash(to, &hashes) && from == to;
+		}
+
+		// Appends the operations which turn from into to, at the path of tokens.
+		void _diff(const _json_value& from, const _json_value& to, std::vector<typename _pointer_alias::_token>& tokens, std::unordered_map<const void*, uint64_t>& hashes) {
+			if (_same(from, to, hashes)) {
+				return;
+			}
+			if (from._type != to._type || (from._type != _json_value::_type_t::OBJECT && from._type != _json_value::_type_t::ARRAY)) {
+				_emit(_operation::_type_t::REPLACE, tokens, to);
+				return;
+			}
+
+			if (from._type == _json_value::_type_t::OBJECT) {
+				auto& from_members = from._object();
+				auto& to_members = to._object();
+				for (auto& [key, value] : from_members) {
+					tokens.push_back({ key, {} });
+					auto member = to_members.find(key);
+					if (member == to_members.end()) {
+						_emit(_operation::_type_t::REMOVE, tokens);
+					}
+					else {
+						_diff(value, member->second, tokens, hashes);
+					}
+					tokens.pop_back();
+				}
+				for (auto& [key, value] : to_members) {
+					if (!from_members.contains(key)) {
+						tokens.push_back({ key, {} });
+						_emit(_operation::_type_t::ADD, tokens, value);
+						tokens.pop_back();
+					}
+				}
+				return;
+			}
+
+			_diff_arrays(from._array(), to._array(), tokens, hashes);
+		}
+
+		// Diffs arrays by the longest common subsequence of their elements, past their common prefix and suffix.
+		// Removals and additions between common elements are paired up and diffed as modifications of one another.
+		void _diff_arrays(const typename _json_value::_array_alias& from, const typename _json_value::_array_alias& to,
+			std::vector<typename _pointer_alias::_token>& tokens, std::unordered_map<const void*, uint64_t>& hashes) {
+
+			size_t begin = 0;
+			while (begin < from.size() && begin < to.size() && _same(from[begin], to[begin], hashes)) {
+				++begin;
+			}
+			size_t from_end = from.size();
+			size_t to_end = to.size();
+			while (from_end > begin && to_end > begin && _same(from[from_end - 1], to[to_end - 1], hashes)) {
+				--from_end;
+				--to_end;
+			}
+
+			const size_t rows = from_end - begin;
+			const size_t columns = to_end - begin;
+
+			// The edit script: the elements of from which are removed and of to which are added, as runs between kept elements.
+			enum class _edit_t { KEEP, REMOVE, ADD };
+			std::vector<_edit_t> script;
+			script.reserve(rows + columns);
+
+			if (rows != 0 && columns != 0 && (rows + 1) * (columns + 1) <= _lcs_limit) {
+				std::vector<uint64_t> from_hashes(rows), to_hashes(columns);
+				for (size_t i = 0; i < rows; ++i) from_hashes[i] = _hasher::_hash(from[begin + i], &hashes);
+				for (size_t j = 0; j < columns; ++j) to_hashes[j] = _hasher::_hash(to[begin + j], &hashes);
+				auto equal = [&](const size_t i, const size_t j) {
+					return from_hashes[i] == to_hashes[j] && from[begin + i] == to[begin + j];
+				};
+
+				// lengths[i * (columns + 1) + j] is the length of the LCS of the elements from i and from j on.
+				std::vector<uint32_t> lengths((rows + 1) * (columns + 1), 0);
+				for (size_t i = rows; i-- > 0;) {
+					for (size_t j = columns; j-- > 0;) {
+						lengths[i * (columns + 1) + j] = equal(i, j) ? lengths[(i + 1) * (columns + 1) + j + 1] + 1
+							: std::max(lengths[(i + 1) * (columns + 1) + j], lengths[i * (columns + 1) + j + 1]);
+					}
+				}
+				size_t i = 0, j = 0;
+				while (i < rows && j < columns) {
+					if (equal(i, j)) {
+						script.push_back(_edit_t::KEEP);
+						++i;
+						++j;
+					}
+					else if (lengths[(i + 1) * (columns + 1) + j] >= lengths[i * (columns + 1) + j + 1]) {
+						script.push_back(_edit_t::REMOVE);
+						++i;
+					}
+					else {
+						script.push_back(_edit_t::ADD);
+						++j;
+					}
+				}
+				script.insert(script.end(), rows - i, _edit_t::REMOVE);
+				script.insert(script.end(), columns - j, _edit_t::ADD);
+			}
+			else {
+				script.insert(script.end(), rows, _edit_t::REMOVE);
+				script.insert(script.end(), columns, _edit_t::ADD);
+			}
+
+			// index is where the next element is in the array as it is while the operations are applied.
+			size_t index = begin, i = begin, j = begin;
+			for (auto edit = script.begin(); edit != script.end();) {
+				if (*edit == _edit_t::KEEP) {
+					++edit;
+					++index;
+					++i;
+					++j;
+					continue;
+				}
+				const auto run_end = std::find(edit, script.end(), _edit_t::KEEP);
+				const size_t removals = std::count(edit, run_end, _edit_t::REMOVE);
+				const size_t additions = static_cast<size_t>(run_end - edit) - removals;
+				const size_t pairs = std::min(removals, additions);
+				for (size_t p = 0; p < pairs; ++p) {
+					tokens.push_back(_index_token(index++));
+					_diff(from[i + p], to[j + p], tokens, hashes);
+					tokens.pop_back();
+				}
+				for (size_t p = pairs; p < removals; ++p) {
+					tokens.push_back(_index_token(index));
+					_emit(_operation::_type_t::REMOVE, tokens);
+					tokens.pop_back();
+				}
+				for (size_t p = pairs; p < additions; ++p) {
+					tokens.push_back(_index_token(index++));
+					_emit(_operation::_type_t::ADD, tokens, to[j + p]);
+					tokens.pop_back();
+				}
+				i += removals;
+				j += additions;
+				edit = run_end;
+			}
+		}
+
+	public:
+		// An empty patch.
+		json_patch() = default;
+
+		// Parses patch, which must be an array of JSON Patch operations. Throws parsing_error if it is not.
+		json_patch(const _json_value& patch) {
+			if (patch._type != _json_value::_type_t::ARRAY) {
+				PUSH_TO_COUT("JSON Patch was not an array.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+			}
+
+			static const std::pair<const char*, typename _operation::_type_t> types[] = {
+				{ "add", _operation::_type_t::ADD }, { "remove", _operation::_type_t::REMOVE }, { "replace", _operation::_type_t::REPLACE },
+				{ "move", _operation::_type_t::MOVE }, { "copy", _operation::_type_t::COPY }, { "test", _operation::_type_t::TEST }
+			};
+
+			for (auto& op : patch._array()) {
+				if (op._type != _json_value::_type_t::OBJECT) {
+					PUSH_TO_COUT("JSON Patch operation was not an object.\n");
+					throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+				}
+				auto name = _string_member(op, _name("op"));
+				auto path = _string_member(op, _name("path"));
+				auto type = name ? std::find_if(std::begin(types), std::end(types), [name](auto& type) { return *name == _name(type.first); }) : std::end(types);
+				if (type == std::end(types) || !path) {
+					PUSH_TO_COUT("JSON Patch operation lacked a known \"op\" or a \"path\".\n");
+					throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+				}
+
+				_operation operation{ type->second, _pointer_alias(*path), {}, {} };
+				switch (operation._type) {
+				case _operation::_type_t::MOVE:
+				case _operation::_type_t::COPY: {
+					auto from = _string_member(op, _name("from"));
+					if (!from) {
+						PUSH_TO_COUT("JSON Patch operation lacked a \"from\".\n");
+						throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+					}
+					operation._from = _pointer_alias(*from);
+					break;
+				}
+				case _operation::_type_t::ADD:
+				case _operation::_type_t::REPLACE:
+				case _operation::_type_t::TEST: {
+					auto& obj = op._object();
+					auto value = obj.find(_name("value"));
+					if (value == obj.end()) {
+						PUSH_TO_COUT("JSON Patch operation lacked a \"value\".\n");
+						throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, {}, {} };
+					}
+					operation._value = value->second;
+					break;
+				}
+				default:
+					break;
+				}
+				_operations.push_back(std::move(operation));
+			}
+		}
+
+		// Applies the patch to target. If an operation fails, every operation before it is undone, and interface_misuse is thrown:
+		// NO_SUCH_KEY or INDEX_OUT_OF_RANGE if a path does not exist, INCORRECT_TYPE if a path goes through a value which is not an array or object,
+		// or if a value would be moved into itself, and TEST_FAILED if a test operation fails. Tests compare numbers by value, so 1 equals 1.0.
+		void apply(_json_value& target) const {
+			std::vector<_undo> log;
+			try {
+				for (auto& operation : _operations) {
+					switch (operation._type) {
+					case _operation::_type_t::ADD:
+						_add(target, operation._path, _json_value(operation._value), log, false);
+						break;
+					case _operation::_type_t::REMOVE:
+						_remove(target, operation._path, log, false);
+						break;
+					case _operation::_type_t::REPLACE:
+						_replace(target, operation._path, operation._value, log);
+						break;
+					case _operation::_type_t::MOVE: {
+						auto& from = operation._from._tokens;
+						auto& path = operation._path._tokens;
+						if (from.size() < path.size() && std::equal(from.begin(), from.end(), path.begin(),
+							[](auto& lhs, auto& rhs) { return lhs._key == rhs._key; })) {
+							throw interface_misuse::INCORRECT_TYPE;
+						}
+						// The removal's undo takes the value back from where it is added, so if it cannot be added, the undo is given the value instead.
+						auto value = _remove(target, operation._from, log, true);
+						try {
+							_add(target, operation._path, std::move(value), log, true);
+						}
+						catch (...) {
+							log.back()._old = std::move(value);
+							log.back()._stashed = false;
+							throw;
+						}
+						break;
+					}
+					case _operation::_type_t::COPY: {
+						auto source = operation._from.resolve(target);
+						if (!source) {
+							throw interface_misuse::NO_SUCH_KEY;
+						}
+						_add(target, operation._path, _json_value(*source), log, false);
+						break;
+					}
+					case _operation::_type_t::TEST: {
+						auto value = operation._path.resolve(target);
+						if (!value || !_numeric_equality::_equal(*value, operation._value)) {
+							throw interface_misuse::TEST_FAILED;
+						}
+						break;
+					}
+					}
+				}
+			}
+			catch (...) {
+				_roll_back(target, log);
+				throw;
+			}
+		}
+
+		// Returns the patch as a JSON Patch document.
+		[[nodiscard]] _json_value to_value() const {
+			static const char* names[] = { "add", "remove", "replace", "move", "copy", "test" };
+			typename _json_value::_array_alias patch;
+			patch.reserve(_operations.size());
+			for (auto& operation : _operations) {
+				typename _json_value::_object_alias op;
+				op.emplace(_name("op"), _json_value(_name(names[static_cast<size_t>(operation._type)])));
+				op.emplace(_name("path"), _json_value(operation._path.to_string()));
+				if (operation._type == _operation::_type_t::MOVE || operation._type == _operation::_type_t::COPY) {
+					op.emplace(_name("from"), _json_value(operation._from.to_string()));
+				}
+				if (operation._type == _operation::_type_t::ADD || operation._type == _operation::_type_t::REPLACE || operation._type == _operation::_type_t::TEST) {
+					op.emplace(_name("value"), operation._value);
+				}
+				patch.push_back(_json_value(std::move(op)));
+			}
+			return _json_value(std::move(patch));
+		}
+
+		// Returns how many operations the patch consists of.
+		[[nodiscard]] size_t size() const {
+			return _operations.size();
+		}
+
+		// Returns a patch which turns from into to. Subtrees which are equal, as shared containers or by their hashes, are skipped without
+		// being walked, objects are diffed member by member, and arrays by the longest common subsequence of the elements which differ.
+		[[nodiscard]] static json_patch diff(const _json_value& from, const _json_value& to) {
+			json_patch patch;
+			std::vector<typename _pointer_alias::_token> tokens;
+			std::unordered_map<const void*, uint64_t> hashes;
+			patch._diff(from, to, tokens, hashes);
+			return patch;
+		}
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to.
+	// Applies JSON Merge Patches (RFC 7386), moving the values out of a patch which is an rvalue, and otherwise copying only those which are inserted.
+	class _merger {
+		template <typename json_value, typename patch_type>
+		static void _merge(json_value& target, patch_type&& patch) {
+			constexpr bool movable = !std::is_lvalue_reference_v<patch_type>;
+			using element_t = std::conditional_t<movable, json_value&&, const json_value&>;
+
+			if (patch._type != json_value::_type_t::OBJECT) {
+				target = static_cast<element_t>(patch);
+				return;
+			}
+			if (target._type != json_value::_type_t::OBJECT) {
+				target = json_value(typename json_value::_object_alias());
+			}
+
+			auto& members = target._mutable_object();
+			auto& patch_members = [&]() -> auto& {
+				if constexpr (movable) {
+					return patch._mutable_object();
+				}
+				else {
+					return patch._object();
+				}
+			}();
+			for (auto& [key, value] : patch_members) {
+				if (value._type == json_value::_type_t::NULL_VALUE) {
+					members.erase(key);
+					continue;
+				}
+				auto member = members.find(key);
+				if (member != members.end()) {
+					_merge(member->second, static_cast<element_t>(value));
+				}
+				else if (value._type == json_value::_type_t::OBJECT) {
+					// Merged into nothing, so that the nulls within it are removed.
+					_merge(members[key], static_cast<element_t>(value));
+				}
+				else {
+					members.emplace(key, static_cast<element_t>(value));
+				}
+			}
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend void merge_patch(value_type<I, F, S>&, const value_type<I, F, S>&);
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend void merge_patch(value_type<I, F, S>&, value_type<I, F, S>&&);
+	};
+
+	// Applies patch to target as a JSON Merge Patch (RFC 7386): members of patch which are null remove the member of target,
+	// other members are merged into the member of target, and anything but an object replaces target.
+	// Only members of target which are in patch are touched, and only the values inserted into target are copied out of patch.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void merge_patch(value_type<integer_type, floating_point_type, string_type>& target, const value_type<integer_type, floating_point_type, string_type>& patch) {
+		_merger::_merge(target, patch);
+	};
+
+	// Applies patch to target as above, but moves the values out of patch rather than copying them.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void merge_patch(value_type<integer_type, floating_point_type, string_type>& target, value_type<integer_type, floating_point_type, string_type>&& patch) {
+		_merger::_merge(target, std::move(patch));
+	};
+
+	// A JSONPath query (RFC 9535), which is compiled once into a plan and may then be executed against any number of values.
+	// Supports names, indices, slices, wildcards, unions, descendants and filters with comparisons, existence tests, '!', '&&' and '||',
+	// and the function extensions length(), count(), match(), search() and value(). The patterns of match() and search() are I-Regexps (RFC 9485),
+	// save for the character properties \p{...} and \P{...}, which make a pattern invalid, and so the call false.
+	template <string_concept string_type>
+	class json_path {
+		using _char_alias = typename string_type::value_type;
+		using _view_alias = std::basic_string_view<_char_alias>;
+
+		// A literal of a filter expression.
+		using _literal_alias = std::variant<std::nullptr_t, bool, long long, long double, string_type>;
+
+		// Selects children of a node.
+		struct _selector {
+			enum class _type_t {
+				NAME,
+				INDEX,
+				SLICE,
+				WILDCARD,
+				FILTER
+			} _type;
+			string_type _name{};
+			long long _index = 0;
+			std::optional<long long> _start{}, _end{};
+			long long _step = 1;
+			size_t _filter = 0;
+		};
+
+		// Applies its selectors to a node, or if descendant, to the node and all of its descendants.
+		struct _segment {
+			bool _descendant;
+			std::vector<_selector> _selectors{};
+		};
+
+		// A query within a filter expression, relative to either the root ($) or the current node (@).
+		struct _query {
+			bool _absolute;
+			std::vector<_segment> _segments{};
+		};
+
+		// An I-Regexp (RFC 9485), as match() and search() take, compiled into a program which is run as a Pike VM, so that matching
+		// takes time linear in the length of the subject. A pattern which is not a valid I-Regexp, or which compiles into too many instructions, matches nothing.
+		struct _regexp {
+			struct _instruction {
+				enum class _type_t {
+					CHARACTER,
+					ANY,
+					CLASS,
+					SPLIT,
+					JUMP,
+					MATCH
+				} _type;
+				// The character, or the index of the class, to accept.
+				uint32_t _operand = 0;
+				// Where a split or a jump continues, relative to the instruction itself.
+				long long _first = 0, _second = 0;
+			};
+			using _fragment_alias = std::vector<_instruction>;
+
+			// A character class: whether it is negated, and its ranges of characters.
+			struct _class {
+				bool _negated = false;
+				std::vector<std::pair<uint32_t, uint32_t>> _ranges{};
+			};
+
+			// Counted repetitions copy what they repeat, so a short pattern may compile into a long program.
+			static constexpr size_t _max_instructions = 1 << 16;
+
+			std::vector<_instruction> _program;
+			std::vector<_class> _classes;
+			bool _valid = false;
+
+			explicit _regexp(const _view_alias pattern) {
+				std::vector<uint32_t> characters;
+				for (size_t position = 0; position < pattern.size();) {
+					characters.push_back(_next_character(pattern, position));
+				}
+				size_t position = 0;
+				_valid = _parse_alternation(characters, position, _program) && position == characters.size();
+				_program.push_back({ _instruction::_type_t::MATCH });
+			}
+
+			// Whether the pattern matches all of subject, or if search, some part of it.
+			bool _matches(const _view_alias subject, const bool search) const {
+				using _type_t = typename _instruction::_type_t;
+
+				if (!_valid) {
+					return false;
+				}
+				std::vector<size_t> current, next, pending;
+				// The step at which each instruction was last added, so that it is added once a step, and empty loops end.
+				std::vector<size_t> added(_program.size(), std::numeric_limits<size_t>::max());
+				size_t step = 0;
+				auto add = [&](std::vector<size_t>& threads, const size_t start) {
+					pending.push_back(start);
+					while (!pending.empty()) {
+						const size_t at = pending.back();
+						pending.pop_back();
+						if (added[at] == step) {
+							continue;
+						}
+						added[at] = step;
+						auto& instruction = _program[at];
+						if (instruction._type == _type_t::SPLIT) {
+							pending.push_back(static_cast<size_t>(static_cast<long long>(at) + instruction._second));
+						}
+						if (instruction._type == _type_t::SPLIT || instruction._type == _type_t::JUMP) {
+							pending.push_back(static_cast<size_t>(static_cast<long long>(at) + instruction._first));
+						}
+						else {
+							threads.push_back(at);
+						}
+					}
+				};
+
+				add(current, 0);
+				for (size_t position = 0;;) {
+					for (const size_t at : current) {
+						if (_program[at]._type == _type_t::MATCH && (search || position == subject.size())) {
+							return true;
+						}
+					}
+					if (position == subject.size() || (current.empty() && !search)) {
+						return false;
+					}
+					const uint32_t character = _next_character(subject, position);
+					++step;
+					next.clear();
+					for (const size_t at : current) {
+						if (_accepts(_program[at], character)) {
+							add(next, at + 1);
+						}
+					}
+					if (search) {
+						add(next, 0);
+					}
+					std::swap(current, next);
+				}
+			}
+
+			bool _accepts(const _instruction& instruction, const uint32_t character) const {
+				switch (instruction._type) {
+				case _instruction::_type_t::CHARACTER: return character == instruction._operand;
+				case _instruction::_type_t::ANY:       return character != '\n' && character != '\r';
+				case _instruction::_type_t::CLASS: {
+					auto& character_class = _classes[instruction._operand];
+					const bool within = std::any_of(character_class._ranges.cbegin(), character_class._ranges.cend(),
+						[character](const std::pair<uint32_t, uint32_t>& range) { return range.first <= character && character <= range.second; });
+					return within != character_class._negated;
+				}
+				default: return false;
+				}
+			}
+
+			// Parses branches separated by '|'.
+			bool _parse_alternation(const std::vector<uint32_t>& pattern, size_t& position, _fragment_alias& fragment) {
+				if (!_parse_branch(pattern, position, fragment)) {
+					return false;
+				}
+				while (position < pattern.size() && pattern[position] == '|') {
+					++position;
+					_fragment_alias other;
+					if (!_parse_branch(pattern, position, other)) {
+						return false;
+					}
+					// Splits into the branches before and the one after, and jumps past the latter at the end of the former.
+					fragment.insert(fragment.begin(), { _instruction::_type_t::SPLIT, 0, 1, static_cast<long long>(fragment.size()) + 2 });
+					fragment.push_back({ _instruction::_type_t::JUMP, 0, static_cast<long long>(other.size()) + 1 });
+					fragment.insert(fragment.end(), other.cbegin(), other.cend());
+					if (fragment.size() > _max_instructions) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			// Parses atoms, each with an optional quantifier, until the end of the branch.
+			bool _parse_branch(const std::vector<uint32_t>& pattern, size_t& position, _fragment_alias& fragment) {
+				while (position < pattern.size() && pattern[position] != '|' && pattern[position] != ')') {
+					_fragment_alias atom;
+					if (!_parse_atom(pattern, position, atom) || !_parse_quantifier(pattern, position, atom)) {
+						return false;
+					}
+					fragment.insert(fragment.end(), atom.cbegin(), atom.cend());
+					if (fragment.size() > _max_instructions) {
+						return false;
+					}
+				}
+				return true;
+			}
+
+			bool _parse_atom(const std::vector<uint32_t>& pattern, size_t& position, _fragment_alias& atom) {
+				const uint32_t character = pattern[position++];
+				switch (character) {
+				case '(':
+					if (!_parse_alternation(pattern, position, atom) || position == pattern.size() || pattern[position] != ')') {
+						return false;
+					}
+					++position;
+					return true;
+				case '.':
+					atom.push_back({ _instruction::_type_t::ANY });
+					return true;
+				case '[':
+					return _parse_class(pattern, position, atom);
+				case '\\': {
+					uint32_t escaped;
+					if (!_parse_escape(pattern, position, escaped)) {
+						return false;
+					}
+					atom.push_back({ _instruction::_type_t::CHARACTER, escaped });
+					return true;
+				}
+				case '*': case '+': case '?': case '{': case '}': case ']':
+					return false;
+				default:
+					atom.push_back({ _instruction::_type_t::CHARACTER, character });
+					return true;
+				}
+			}
+
+			// Parses what follows a '\', which escapes one of the characters with a meaning of their own, or stands for \n, \r or \t.
+			static bool _parse_escape(const std::vector<uint32_t>& pattern, size_t& position, uint32_t& character) {
+				if (position == pattern.size()) {
+					return false;
+				}
+				character = pattern[position++];
+				switch (character) {
+				case 'n': character = '\n'; return true;
+				case 'r': character = '\r'; return true;
+				case 't': character = '\t'; return true;
+				case '(': case ')': case '*': case '+': case '-': case '.': case '?':
+				case '[': case '\\': case ']': case '^': case '{': case '|': case '}':
+					return true;
+				default:
+					return false;
+				}
+			}
+
+			// Parses a character class after its '['. A '-' stands for itself only first or last.
+			bool _parse_class(const std::vector<uint32_t>& pattern, size_t& position, _fragment_alias& atom) {
+				_class character_class;
+				if (position < pattern.size() && pattern[position] == '^') {
+					character_class._negated = true;
+					++position;
+				}
+				auto parse_character = [&](uint32_t& character) {
+					character = pattern[position++];
+					if (character == '\\') {
+						return _parse_escape(pattern, position, character);
+					}
+					return character != '[' && character != ']' && character != '-';
+				};
+				for (bool first = true;; first = false) {
+					if (position == pattern.size()) {
+						return false;
+					}
+					if (pattern[position] == ']' && !first) {
+						++position;
+						break;
+					}
+					if (pattern[position] == '-' && (first || (position + 1 < pattern.size() && pattern[position + 1] == ']'))) {
+						character_class._ranges.push_back({ '-', '-' });
+						++position;
+						continue;
+					}
+					uint32_t low, high;
+					if (!parse_character(low)) {
+						return false;
+					}
+					high = low;
+					if (position + 1 < pattern.size() && pattern[position] == '-' && pattern[position + 1] != ']') {
+						++position;
+						if (!parse_character(high) || high < low) {
+							return false;
+						}
+					}
+					character_class._ranges.push_back({ low, high });
+				}
+				_classes.push_back(std::move(character_class));
+				atom.push_back({ _instruction::_type_t::CLASS, static_cast<uint32_t>(_classes.size() - 1) });
+				return true;
+			}
+
+			// Parses the quantifier of atom, if it has one, and repeats atom accordingly.
+			static bool _parse_quantifier(const std::vector<uint32_t>& pattern, size_t& position, _fragment_alias& atom) {
+				constexpr size_t unbounded = std::numeric_limits<size_t>::max();
+				size_t minimum, maximum;
+				if (position == pattern.size()) {
+					return true;
+				}
+				switch (pattern[position]) {
+				case '*': minimum = 0; maximum = unbounded; ++position; break;
+				case '+': minimum = 1; maximum = unbounded; ++position; break;
+				case '?': minimum = 0; maximum = 1; ++position; break;
+				case '{': {
+					++position;
+					auto parse_count = [&](size_t& count) {
+						const size_t begin = position;
+						for (count = 0; position < pattern.size() && '0' <= pattern[position] && pattern[position] <= '9'; ++position) {
+							count = std::min(count * 10 + (pattern[position] - '0'), _max_instructions);
+						}
+						return position != begin;
+					};
+					if (!parse_count(minimum)) {
+						return false;
+					}
+					maximum = minimum;
+					if (position < pattern.size() && pattern[position] == ',') {
+						++position;
+						maximum = unbounded;
+						if (position < pattern.size() && pattern[position] != '}' && (!parse_count(maximum) || maximum < minimum)) {
+							return false;
+						}
+					}
+					if (position == pattern.size() || pattern[position] != '}') {
+						return false;
+					}
+					++position;
+					break;
+				}
+				default:
+					return true;
+				}
+
+				const size_t copies = maximum == unbounded ? minimum + 1 : maximum;
+				if (copies > _max_instructions / (atom.size() + 2)) {
+					return false;
+				}
+				const _fragment_alias once = std::move(atom);
+				const long long size = static_cast<long long>(once.size());
+				atom.clear();
+				for (size_t i = 0; i < minimum; ++i) {
+					atom.insert(atom.end(), once.cbegin(), once.cend());
+				}
+				if (maximum == unbounded) {
+					// Splits into once and past it, and jumps back to the split after it.
+					atom.push_back({ _instruction::_type_t::SPLIT, 0, 1, size + 2 });
+					atom.insert(atom.end(), once.cbegin(), once.cend());
+					atom.push_back({ _instruction::_type_t::JUMP, 0, -(size + 1) });
+					return true;
+				}
+				for (size_t i = minimum; i < maximum; ++i) {
+					atom.push_back({ _instruction::_type_t::SPLIT, 0, 1, size + 1 });
+					atom.insert(atom.end(), once.cbegin(), once.cend());
+				}
+				return true;
+			}
+		};
+
+		// Refers to a call of a function extension by its index.
+		struct _call_index {
+			size_t _index;
+		};
+
+		// An operand of a filter expression, or an argument of a function extension: a query, a literal, or a call.
+		using _term_alias = std::variant<_query, _literal_alias, _call_index>;
+
+		// A call of a function extension within a filter expression.
+		struct _call {
+			enum class _function_t {
+				LENGTH,
+				COUNT,
+				MATCH,
+				SEARCH,
+				VALUE
+			} _function;
+			std::vector<_term_alias> _arguments{};
+			// The pattern of match or search, compiled once if it is a literal.
+			std::optional<_regexp> _pattern{};
+		};
+
+		// A node of a filter expression. Operators refer to their operand expressions by index.
+		struct _expression {
+			enum class _type_t {
+				OR,
+				AND,
+				NOT,
+				EXISTS,
+				CALL,
+				EQUAL,
+				NOT_EQUAL,
+				LESS,
+				LESS_EQUAL,
+				GREATER,
+				GREATER_EQUAL
+			} _type;
+			size_t _lhs = 0, _rhs = 0;
+			_term_alias _left{}, _right{};
+		};
+
+		// The compiled plan.
+		std::vector<_segment> _segments;
+		std::vector<_expression> _expressions;
+		std::vector<_call> _calls;
+
+		// Compilation
+
+		[[noreturn]] static void _throw_at(const size_t position) {
+			PUSH_TO_COUT("Unexpected character in JSONPath at " << position + 1 << ".\n");
+			throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, 1, static_cast<uint16_t>(position + 1) };
+		}
+
+		static void _skip_blank(const _view_alias text, size_t& position) {
+			while (position < text.size() && (text[position] == ' ' || text[position] == '\t' || text[position] == '\n' || text[position] == '\r')) {
+				++position;
+			}
+		}
+
+		static bool _accept(const _view_alias text, size_t& position, const std::string_view expected) {
+			if (text.size() - position < expected.size()) {
+				return false;
+			}
+			for (size_t i = 0; i < expected.size(); ++i) {
+				if (text[position + i] != static_cast<_char_alias>(expected[i])) {
+					return false;
+				}
+			}
+			position += expected.size();
+			return true;
+		}
+
+		// Accepts a keyword, such as true, only if no name character follows it.
+		static bool _accept_word(const _view_alias text, size_t& position, const std::string_view expected) {
+			size_t end = position;
+			if (!_accept(text, end, expected) || (end < text.size() && (_is_name_first(text[end]) || _is_digit(text[end])))) {
+				return false;
+			}
+			position = end;
+			return true;
+		}
+
+		static void _expect(const _view_alias text, size_t& position, const std::string_view expected) {
+			if (!_accept(text, position, expected)) {
+				_throw_at(position);
+			}
+		}
+
+		static bool _is_digit(const _char_alias c) {
+			return '0' <= c && c <= '9';
+		}
+
+		static bool _is_name_first(const _char_alias c) {
+			return ('a' <= c && c <= 'z') || ('A' <= c && c <= 'Z') || c == '_' || static_cast<std::make_unsigned_t<_char_alias>>(c) >= 0x80;
+		}
+
+		// Reads the character of text at position, and moves past it. A narrow string is read as UTF-8, save that a byte which does not begin
+		// a valid sequence is a character of its own, as \u escapes below 0x100 are held, and a wide string of 16 bits is read as UTF-16.
+		static uint32_t _next_character(const _view_alias text, size_t& position) {
+			const uint32_t first = static_cast<std::make_unsigned_t<_char_alias>>(text[position++]);
+			if constexpr (sizeof(_char_alias) == 1) {
+				const size_t length = first < 0xC2 ? 1 : first < 0xE0 ? 2 : first < 0xF0 ? 3 : first < 0xF5 ? 4 : 1;
+				if (length == 1 || text.size() - position < length - 1) {
+					return first;
+				}
+				uint32_t character = first & (0x7F >> length);
+				for (size_t i = 0; i < length - 1; ++i) {
+					const uint32_t next = static_cast<std::make_unsigned_t<_char_alias>>(text[position + i]);
+					if ((next & 0xC0) != 0x80) {
+						return first;
+					}
+					character = (character << 6) | (next & 0x3F);
+				}
+				// Overlong sequences, surrogates and code points past Unicode are not valid either.
+				constexpr uint32_t lowest[] = { 0, 0, 0x80, 0x800, 0x10000 };
+				if (character < lowest[length] || (0xD800 <= character && character < 0xE000) || character > 0x10FFFF) {
+					return first;
+				}
+				position += length - 1;
+				return character;
+			}
+			else if constexpr (sizeof(_char_alias) == 2) {
+				if (0xD800 <= first && first < 0xDC00 && position < text.size()) {
+					const uint32_t second = static_cast<std::make_unsigned_t<_char_alias>>(text[position]);
+					if (0xDC00 <= second && second < 0xE000) {
+						++position;
+						return 0x10000 + ((first - 0xD800) << 10) + (second - 0xDC00);
+					}
+				}
+				return first;
+			}
+			else {
+				return first;
+			}
+		}
+
+		// Parses an integer, such as an index or a slice bound.
+		static long long _parse_integer(const _view_alias text, size_t& position) {
+			const size_t begin = position;
+			const bool negative = _accept(text, position, "-");
+			if (position == text.size() || !_is_digit(text[position])) {
+				_throw_at(position);
+			}
+			long long value = 0;
+			for (; position < text.size() && _is_digit(text[position]); ++position) {
+				if (value > (std::numeric_limits<long long>::max() - 9) / 10) {
+					_throw_at(begin);
+				}
+				value = value * 10 + static_cast<long long>(text[position] - '0');
+			}
+			return negative ? -value : value;
+		}
+
+		// Parses a string literal delimited by ' or ".
+		static string_type _parse_string_literal(const _view_alias text, size_t& position) {
+			const _char_alias quote = text[position++];
+			string_type value;
+			while (position < text.size() && text[position] != quote) {
+				if (text[position] != '\\') {
+					value.push_back(text[position++]);
+					continue;
+				}
+				if (++position == text.size()) {
+					_throw_at(position);
+				}
+				switch (text[position]) {
+				case 'b': value.push_back('\b'); break;
+				case 'f': value.push_back('\f'); break;
+				case 'n': value.push_back('\n'); break;
+				case 'r': value.push_back('\r'); break;
+				case 't': value.push_back('\t'); break;
+				case '/': case '\\': case '\'': case '\"': value.push_back(text[position]); break;
+				case 'u': {
+					if (text.size() - position < 5) {
+						_throw_at(position);
+					}
+					uint32_t code = 0;
+					for (size_t i = 1; i <= 4; ++i) {
+						const _char_alias c = text[position + i];
+						code <<= 4;
+						if (_is_digit(c)) code |= c - '0';
+						else if ('a' <= c && c <= 'f') code |= c - 'a' + 10;
+						else if ('A' <= c && c <= 'F') code |= c - 'A' + 10;
+						else _throw_at(position + i);
+					}
+					if (code > static_cast<uint32_t>(std::numeric_limits<std::make_unsigned_t<_char_alias>>::max())) {
+						throw parsing_error{ parsing_error::type_t::STRING_TYPE_TOO_NARROW, 1, static_cast<uint16_t>(position + 1) };
+					}
+					value.push_back(static_cast<_char_alias>(code));
+					position += 4;
+					break;
+				}
+				default:
+					throw parsing_error{ parsing_error::type_t::BAD_REVERSE_SOLIDUS, 1, static_cast<uint16_t>(position + 1) };
+				}
+				++position;
+			}
+			if (position == text.size()) {
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, 1, static_cast<uint16_t>(position + 1) };
+			}
+			++position;
+			return value;
+		}
+
+		// Parses an index or slice selector.
+		static _selector _parse_index_or_slice(const _view_alias text, size_t& position) {
+			_selector selector{ _selector::_type_t::INDEX };
+			if (position < text.size() && text[position] != ':') {
+				selector._index = _parse_integer(text, position);
+				_skip_blank(text, position);
+				if (!_accept(text, position, ":")) {
+					return selector;
+				}
+				selector._start = selector._index;
+			}
+			else {
+				_expect(text, position, ":");
+			}
+			selector._type = _selector::_type_t::SLICE;
+			_skip_blank(text, position);
+			if (position < text.size() && (text[position] == '-' || _is_digit(text[position]))) {
+				selector._end = _parse_integer(text, position);
+				_skip_blank(text, position);
+			}
+			if (_accept(text, position, ":")) {
+				_skip_blank(text, position);
+				if (position < text.size() && (text[position] == '-' || _is_digit(text[position]))) {
+					selector._step = _parse_integer(text, position);
+				}
+			}
+			return selector;
+		}
+
+		// Parses the selectors between [ and ].
+		void _parse_bracket(const _view_alias text, size_t& position, std::vector<_selector>& selectors) {
+			_expect(text, position, "[");
+			do {
+				_skip_blank(text, position);
+				if (position == text.size()) {
+					_throw_at(position);
+				}
+				const _char_alias c = text[position];
+				if (c == '\'' || c == '\"') {
+					selectors.push_back({ _selector::_type_t::NAME, _parse_string_literal(text, position) });
+				}
+				else if (c == '*') {
+					++position;
+					selectors.push_back({ _selector::_type_t::WILDCARD });
+				}
+				else if (c == '?') {
+					++position;
+					_selector selector{ _selector::_type_t::FILTER };
+					selector._filter = _parse_or(text, position);
+					selectors.push_back(std::move(selector));
+				}
+				else {
+					selectors.push_back(_parse_index_or_slice(text, position));
+				}
+				_skip_blank(text, position);
+			} while (_accept(text, position, ","));
+			_expect(text, position, "]");
+		}
+
+		// Parses segments for as long as they continue.
+		void _parse_segments(const _view_alias text, size_t& position, std::vector<_segment>& segments) {
+			for (;;) {
+				size_t next = position;
+				_skip_blank(text, next);
+				if (next == text.size() || (text[next] != '.' && text[next] != '[')) {
+					return;
+				}
+				position = next;
+
+				_segment segment{ false };
+				if (_accept(text, position, "..")) {
+					segment._descendant = true;
+					if (position < text.size() && text[position] == '[') {
+						_parse_bracket(text, position, segment._selectors);
+						segments.push_back(std::move(segment));
+						continue;
+					}
+				}
+				else if (!_accept(text, position, ".")) {
+					_parse_bracket(text, position, segment._selectors);
+					segments.push_back(std::move(segment));
+					continue;
+				}
+
+				// Shorthands: .name or .*
+				if (_accept(text, position, "*")) {
+					segment._selectors.push_back({ _selector::_type_t::WILDCARD });
+				}
+				else {
+					if (position == text.size() || !_is_name_first(text[position])) {
+						_throw_at(position);
+					}
+					const size_t begin = position;
+					while (position < text.size() && (_is_name_first(text[position]) || _is_digit(text[position]))) {
+						++position;
+					}
+					segment._selectors.push_back({ _selector::_type_t::NAME, string_type(text.substr(begin, position - begin)) });
+				}
+				segments.push_back(std::move(segment));
+			}
+		}
+
+		// Returns whether the query selects at most one node, as comparison operands must.
+		static bool _is_singular(const _query& query) {
+			return std::all_of(query._segments.cbegin(), query._segments.cend(), [](const _segment& segment) {
+				return !segment._descendant && segment._selectors.size() == 1 &&
+					(segment._selectors.front()._type == _selector::_type_t::NAME || segment._selectors.front()._type == _selector::_type_t::INDEX);
+			});
+		}
+
+		// Whether the term is a value, as comparisons and the arguments of length, match and search must be: a literal, a singular query,
+		// or a call of a function which returns a value.
+		bool _is_value(const _term_alias& term) const {
+			if (auto query = std::get_if<_query>(&term)) {
+				return _is_singular(*query);
+			}
+			if (auto call = std::get_if<_call_index>(&term)) {
+				const auto function = _calls[call->_index]._function;
+				return function == _call::_function_t::LENGTH || function == _call::_function_t::COUNT || function == _call::_function_t::VALUE;
+			}
+			return true;
+		}
+
+		// Parses a call of a function extension, and checks that it is well typed: length, match and search take values,
+		// and count and value take queries, which may select any number of nodes.
+		_term_alias _parse_call(const _view_alias text, size_t& position) {
+			using _function_t = typename _call::_function_t;
+			static constexpr std::pair<std::string_view, _function_t> functions[] = {
+				{ "length", _function_t::LENGTH }, { "count", _function_t::COUNT }, { "match", _function_t::MATCH },
+				{ "search", _function_t::SEARCH }, { "value", _function_t::VALUE } };
+
+			_call call{ _function_t::LENGTH };
+			const auto known = std::find_if(std::cbegin(functions), std::cend(functions), [&](auto& function) {
+				size_t end = position;
+				return _accept(text, end, function.first) && text[end] == '(';
+			});
+			if (known == std::cend(functions)) {
+				_throw_at(position);
+			}
+			call._function = known->second;
+			position += known->first.size() + 1;
+
+			const bool takes_queries = call._function == _function_t::COUNT || call._function == _function_t::VALUE;
+			const size_t parameters = call._function == _function_t::MATCH || call._function == _function_t::SEARCH ? 2 : 1;
+			for (size_t i = 0; i < parameters; ++i) {
+				if (i != 0) {
+					_skip_blank(text, position);
+					_expect(text, position, ",");
+				}
+				_skip_blank(text, position);
+				const size_t argument_position = position;
+				auto argument = _parse_operand(text, position);
+				if (takes_queries ? !std::holds_alternative<_query>(argument) : !_is_value(argument)) {
+					_throw_at(argument_position);
+				}
+				call._arguments.push_back(std::move(argument));
+			}
+			_skip_blank(text, position);
+			_expect(text, position, ")");
+
+			if (parameters == 2) {
+				if (auto literal = std::get_if<_literal_alias>(&call._arguments.back())) {
+					if (auto pattern = std::get_if<string_type>(literal)) {
+						call._pattern.emplace(*pattern);
+					}
+				}
+			}
+			_calls.push_back(std::move(call));
+			return _call_index{ _calls.size() - 1 };
+		}
+
+		// Parses a query, a literal or a call of a function extension, as an operand of a filter expression.
+		_term_alias _parse_operand(const _view_alias text, size_t& position) {
+			_skip_blank(text, position);
+			if (position == text.size()) {
+				_throw_at(position);
+			}
+			const _char_alias c = text[position];
+			if (c == '@' || c == '$') {
+				++position;
+				_query query{ c == '$' };
+				_parse_segments(text, position, query._segments);
+				return query;
+			}
+			if (c == '\'' || c == '\"') {
+				return _literal_alias(_parse_string_literal(text, position));
+			}
+			if ('a' <= c && c <= 'z') {
+				size_t end = position;
+				while (end < text.size() && (('a' <= text[end] && text[end] <= 'z') || _is_digit(text[end]) || text[end] == '_')) {
+					++end;
+				}
+				if (end < text.size() && text[end] == '(') {
+					return _parse_call(text, position);
+				}
+			}
+			if (_accept_word(text, position, "true")) return _literal_alias(true);
+			if (_accept_word(text, position, "false")) return _literal_alias(false);
+			if (_accept_word(text, position, "null")) return _literal_alias(nullptr);
+			if (c == '-' || _is_digit(c)) {
+				const size_t begin = position;
+				const long long integer = _parse_integer(text, position);
+				if (position == text.size() || (text[position] != '.' && text[position] != 'e' && text[position] != 'E')) {
+					return _literal_alias(integer);
+				}
+				std::string number;
+				for (size_t i = begin; i < position; ++i) number.push_back(static_cast<char>(text[i]));
+				if (_accept(text, position, ".")) {
+					number.push_back('.');
+					if (position == text.size() || !_is_digit(text[position])) {
+						_throw_at(position);
+					}
+					while (position < text.size() && _is_digit(text[position])) number.push_back(static_cast<char>(text[position++]));
+				}
+				if (position < text.size() && (text[position] == 'e' || text[position] == 'E')) {
+					number.push_back('e');
+					++position;
+					if (position < text.size() && (text[position] == '+' || text[position] == '-')) number.push_back(static_cast<char>(text[position++]));
+					if (position == text.size() || !_is_digit(text[position])) {
+						_throw_at(position);
+					}
+					while (position < text.size() && _is_digit(text[position])) number.push_back(static_cast<char>(text[position++]));
+				}
+				return _literal_alias(std::stold(number));
+			}
+			_throw_at(position);
+		}
+
+		// Parses a comparison, an existence test, a negation or a parenthesized expression.
+		size_t _parse_unary(const _view_alias text, size_t& position) {
+			_skip_blank(text, position);
+			if (_accept(text, position, "!")) {
+				_skip_blank(text, position);
+
+				// Only a parenthesized expression or an existence test may be negated, not a comparison.
+				const size_t operand_position = position;
+				size_t operand;
+				if (_accept(text, position, "(")) {
+					operand = _parse_or(text, position);
+					_skip_blank(text, position);
+					_expect(text, position, ")");
+				}
+				else {
+					operand = _parse_unary(text, position);
+					if (_expressions[operand]._type != _expression::_type_t::EXISTS && _expressions[operand]._type != _expression::_type_t::CALL) {
+						_throw_at(operand_position);
+					}
+				}
+				_expressions.push_back({ _expression::_type_t::NOT, operand });
+				return _expressions.size() - 1;
+			}
+			if (_accept(text, position, "(")) {
+				const size_t expression = _parse_or(text, position);
+				_skip_blank(text, position);
+				_expect(text, position, ")");
+				return expression;
+			}
+
+			const size_t operand_position = position;
+			_expression expression{ _expression::_type_t::EXISTS };
+			expression._left = _parse_operand(text, position);
+			_skip_blank(text, position);
+
+			static constexpr std::pair<std::string_view, typename _expression::_type_t> comparisons[] = {
+				{ "==", _expression::_type_t::EQUAL }, { "!=", _expression::_type_t::NOT_EQUAL },
+				{ "<=", _expression::_type_t::LESS_EQUAL }, { ">=", _expression::_type_t::GREATER_EQUAL },
+				{ "<", _expression::_type_t::LESS }, { ">", _expression::_type_t::GREATER } };
+			for (auto& [symbol, type] : comparisons) {
+				if (_accept(text, position, symbol)) {
+					expression._type = type;
+					const size_t right_position = position;
+					expression._right = _parse_operand(text, position);
+					if (!_is_value(expression._right)) {
+						_throw_at(right_position);
+					}
+					break;
+				}
+			}
+
+			if (expression._type != _expression::_type_t::EXISTS) {
+				if (!_is_value(expression._left)) {
+					_throw_at(operand_position);
+				}
+			}
+			else if (std::holds_alternative<_call_index>(expression._left)) {
+				// Only match and search, which return whether they matched, are tests of their own.
+				if (_is_value(expression._left)) {
+					_throw_at(operand_position);
+				}
+				expression._type = _expression::_type_t::CALL;
+			}
+			else if (!std::holds_alternative<_query>(expression._left)) {
+				// A lone literal is not a test.
+				_throw_at(operand_position);
+			}
+
+			_expressions.push_back(std::move(expression));
+			return _expressions.size() - 1;
+		}
+
+		size_t _parse_and(const _view_alias text, size_t& position) {
+			size_t lhs = _parse_unary(text, position);
+			_skip_blank(text, position);
+			while (_accept(text, position, "&&")) {
+				const size_t rhs = _parse_unary(text, position);
+				_expressions.push_back({ _expression::_type_t::AND, lhs, rhs });
+				lhs = _expressions.size() - 1;
+				_skip_blank(text, position);
+			}
+			return lhs;
+		}
+
+		size_t _parse_or(const _view_alias text, size_t& position) {
+			size_t lhs = _parse_and(text, position);
+			_skip_blank(text, position);
+			while (_accept(text, position, "||")) {
+				const size_t rhs = _parse_and(text, position);
+				_expressions.push_back({ _expression::_type_t::OR, lhs, rhs });
+				lhs = _expressions.size() - 1;
+				_skip_blank(text, position);
+			}
+			return lhs;
+		}
+
+		// Execution
+
+		// Calls next on each child of node, in order, until next returns false. Returns false if stopped.
+		template <std::integral integer_type, std::floating_point floating_point_type, typename callback_type>
+		static bool _for_each_child(const value_type<integer_type, floating_point_type, string_type>& node, callback_type& next) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (node._type == json_value::_type_t::ARRAY) {
+				for (auto& element : node._array()) {
+					if (!next(element)) return false;
+				}
+			}
+			else if (node._type == json_value::_type_t::OBJECT) {
+				for (auto& [key, element] : node._object()) {
+					if (!next(element)) return false;
+				}
+			}
+			return true;
+		}
+
+		// Applies the selectors of segment to node, calling next on every selected node until it returns false. Returns false if stopped.
+		template <std::integral integer_type, std::floating_point floating_point_type, typename callback_type>
+		bool _select(const value_type<integer_type, floating_point_type, string_type>& root, const _segment& segment,
+			const value_type<integer_type, floating_point_type, string_type>& node, callback_type& next) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			for (auto& selector : segment._selectors) {
+				switch (selector._type) {
+				case _selector::_type_t::NAME: {
+					if (node._type != json_value::_type_t::OBJECT) break;
+					auto& obj = node._object();
+					auto it = obj.find(selector._name);
+					if (it != obj.end() && !next(it->second)) return false;
+					break;
+				}
+				case _selector::_type_t::INDEX: {
+					if (node._type != json_value::_type_t::ARRAY) break;
+					auto& arr = node._array();
+					const long long size = static_cast<long long>(arr.size());
+					const long long index = selector._index < 0 ? size + selector._index : selector._index;
+					if (0 <= index && index < size && !next(arr[static_cast<size_t>(index)])) return false;
+					break;
+				}
+				case _selector::_type_t::SLICE: {
+					if (node._type != json_value::_type_t::ARRAY || selector._step == 0) break;
+					auto& arr = node._array();
+					const long long size = static_cast<long long>(arr.size());
+					auto normalize = [size](const long long i) { return i < 0 ? size + i : i; };
+					if (selector._step > 0) {
+						const long long lower = std::clamp(normalize(selector._start.value_or(0)), 0LL, size);
+						const long long upper = std::clamp(normalize(selector._end.value_or(size)), 0LL, size);
+						// The step is compared with the distance left rather than added first, as a huge step would overflow.
+						for (long long i = lower; i < upper; i += selector._step) {
+							if (!next(arr[static_cast<size_t>(i)])) return false;
+							if (selector._step >= upper - i) break;
+						}
+					}
+					else {
+						const long long upper = std::clamp(selector._start ? normalize(*selector._start) : size - 1, -1LL, size - 1);
+						const long long lower = std::clamp(selector._end ? normalize(*selector._end) : -size - 1, -1LL, size - 1);
+						for (long long i = upper; lower < i; i += selector._step) {
+							if (!next(arr[static_cast<size_t>(i)])) return false;
+							if (selector._step <= lower - i) break;
+						}
+					}
+					break;
+				}
+				case _selector::_type_t::WILDCARD:
+					if (!_for_each_child(node, next)) return false;
+					break;
+				case _selector::_type_t::FILTER: {
+					auto filtered = [&](const json_value& child) {
+						return !_test(root, selector._filter, child) || next(child);
+					};
+					if (!_for_each_child(node, filtered)) return false;
+					break;
+				}
+				}
+			}
+			return true;
+		}
+
+		// Applies the segments from index from onwards to node, calling on_match on every result until it returns false. Returns false if stopped.
+		template <std::integral integer_type, std::floating_point floating_point_type, typename callback_type>
+		bool _walk(const value_type<integer_type, floating_point_type, string_type>& root, const std::vector<_segment>& segments, const size_t from,
+			const value_type<integer_type, floating_point_type, string_type>& node, callback_type& on_match) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (from == segments.size()) {
+				return on_match(node);
+			}
+			auto next = [&](const json_value& selected) {
+				return _walk(root, segments, from + 1, selected, on_match);
+			};
+			if (!segments[from]._descendant) {
+				return _select(root, segments[from], node, next);
+			}
+
+			return _descend(root, segments[from], node, next);
+		}
+
+		// Applies the selectors of segment to node and then to its descendants, in document order. Returns false if stopped.
+		template <std::integral integer_type, std::floating_point floating_point_type, typename callback_type>
+		bool _descend(const value_type<integer_type, floating_point_type, string_type>& root, const _segment& segment,
+			const value_type<integer_type, floating_point_type, string_type>& node, callback_type& next) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (!_select(root, segment, node, next)) {
+				return false;
+			}
+			auto descend = [&](const json_value& child) {
+				return _descend(root, segment, child, next);
+			};
+			return _for_each_child(node, descend);
+		}
+
+		// A value of a comparison, which is either absent, a node, a literal, or a length or count.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		using _operand_alias = std::variant<std::monostate, const value_type<integer_type, floating_point_type, string_type>*, const _literal_alias*, size_t>;
+
+		// Evaluates a comparison operand, or an argument of a function which takes a value, against the current node.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		_operand_alias<integer_type, floating_point_type> _evaluate(const value_type<integer_type, floating_point_type, string_type>& root,
+			const _term_alias& operand, const value_type<integer_type, floating_point_type, string_type>& current) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (auto literal = std::get_if<_literal_alias>(&operand)) {
+				return literal;
+			}
+			if (auto call = std::get_if<_call_index>(&operand)) {
+				return _call_value(root, _calls[call->_index], current);
+			}
+			auto& query = std::get<_query>(operand);
+			const json_value* result = nullptr;
+			auto on_match = [&result](const json_value& match) {
+				result = &match;
+				return false;
+			};
+			_walk(root, query._segments, 0, query._absolute ? root : current, on_match);
+			if (result) {
+				return result;
+			}
+			return std::monostate{};
+		}
+
+		// The string an operand holds, if it holds one.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		static const string_type* _string_of(const _operand_alias<integer_type, floating_point_type>& operand) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (auto literal = std::get_if<const _literal_alias*>(&operand)) {
+				return std::get_if<string_type>(*literal);
+			}
+			if (auto node = std::get_if<const json_value*>(&operand); node && (*node)->_type == json_value::_type_t::STRING) {
+				return &std::get<string_type>(*(*node)->_value);
+			}
+			return nullptr;
+		}
+
+		// Evaluates a call of length, count or value against the current node. The length of a string is its number of characters,
+		// and that of an array or object its number of elements; other values have none, as value has none unless its query selects one node.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		_operand_alias<integer_type, floating_point_type> _call_value(const value_type<integer_type, floating_point_type, string_type>& root,
+			const _call& call, const value_type<integer_type, floating_point_type, string_type>& current) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (call._function == _call::_function_t::LENGTH) {
+				const auto argument = _evaluate(root, call._arguments.front(), current);
+				if (auto string = _string_of<integer_type, floating_point_type>(argument)) {
+					size_t length = 0;
+					for (size_t position = 0; position < string->size(); ++length) {
+						_next_character(*string, position);
+					}
+					return length;
+				}
+				if (auto node = std::get_if<const json_value*>(&argument)) {
+					if ((*node)->_type == json_value::_type_t::ARRAY) return (*node)->_array().size();
+					if ((*node)->_type == json_value::_type_t::OBJECT) return (*node)->_object().size();
+				}
+				return std::monostate{};
+			}
+
+			auto& query = std::get<_query>(call._arguments.front());
+			const json_value* result = nullptr;
+			size_t count = 0;
+			auto on_match = [&](const json_value& match) {
+				result = &match;
+				// Value only needs to know whether there is more than one.
+				return ++count < 2 || call._function == _call::_function_t::COUNT;
+			};
+			_walk(root, query._segments, 0, query._absolute ? root : current, on_match);
+			if (call._function == _call::_function_t::COUNT) {
+				return count;
+			}
+			if (count == 1) {
+				return result;
+			}
+			return std::monostate{};
+		}
+
+		// Evaluates a call of match or search against the current node: whether the pattern matches all of the subject, or for search,
+		// some part of it. Either being other than a string, or the pattern not being a valid I-Regexp, makes it false.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		bool _call_matches(const value_type<integer_type, floating_point_type, string_type>& root, const _call& call,
+			const value_type<integer_type, floating_point_type, string_type>& current) const {
+			const bool search = call._function == _call::_function_t::SEARCH;
+			const string_type* subject = _string_of<integer_type, floating_point_type>(_evaluate(root, call._arguments.front(), current));
+			if (!subject) {
+				return false;
+			}
+			if (call._pattern) {
+				return call._pattern->_matches(*subject, search);
+			}
+			const string_type* pattern = _string_of<integer_type, floating_point_type>(_evaluate(root, call._arguments.back(), current));
+			return pattern && _regexp(*pattern)._matches(*subject, search);
+		}
+
+		// Reduces an operand to what comparisons need: its kind, and its number or string, if it is either.
+		struct _comparable {
+			enum class _kind_t {
+				NOTHING,
+				NULL_VALUE,
+				BOOLEAN,
+				NUMBER,
+				STRING,
+				STRUCTURED
+			} _kind;
+			bool _boolean = false;
+			long double _number = 0;
+			const string_type* _string = nullptr;
+			const void* _node = nullptr;
+
+			// The precision the number is held with, so that 8.95 may equal a float holding 8.95.
+			int _digits = std::numeric_limits<long double>::digits;
+
+			// Compares two structured nodes of the type which _node points to.
+			bool (*_node_equal)(const void*, const void*) = nullptr;
+		};
+
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		static bool _node_equal(const void* lhs, const void* rhs) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+			return _numeric_equality::_equal(*static_cast<const json_value*>(lhs), *static_cast<const json_value*>(rhs));
+		}
+
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		static _comparable _to_comparable(const _operand_alias<integer_type, floating_point_type>& operand) {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+			using _kind_t = typename _comparable::_kind_t;
+
+			if (auto literal = std::get_if<const _literal_alias*>(&operand)) {
+				auto& value = **literal;
+				if (std::holds_alternative<std::nullptr_t>(value)) return { _kind_t::NULL_VALUE };
+				if (auto b = std::get_if<bool>(&value)) return { _kind_t::BOOLEAN, *b };
+				if (auto i = std::get_if<long long>(&value)) return { _kind_t::NUMBER, false, static_cast<long double>(*i) };
+				if (auto f = std::get_if<long double>(&value)) return { _kind_t::NUMBER, false, *f };
+				return { _kind_t::STRING, false, 0, &std::get<string_type>(value) };
+			}
+			if (auto size = std::get_if<size_t>(&operand)) {
+				return { _kind_t::NUMBER, false, static_cast<long double>(*size) };
+			}
+			if (auto node = std::get_if<const json_value*>(&operand)) {
+				auto& value = **node;
+				switch (value._type) {
+				case json_value::_type_t::NULL_VALUE:     return { _kind_t::NULL_VALUE };
+				case json_value::_type_t::BOOLEAN:        return { _kind_t::BOOLEAN, std::get<bool>(*value._value) };
+				case json_value::_type_t::INTEGER:        return { _kind_t::NUMBER, false, static_cast<long double>(std::get<integer_type>(*value._value)) };
+				case json_value::_type_t::FLOATING_POINT: return { _kind_t::NUMBER, false, static_cast<long double>(std::get<floating_point_type>(*value._value)),
+					nullptr, nullptr, std::numeric_limits<floating_point_type>::digits };
+				case json_value::_type_t::STRING:         return { _kind_t::STRING, false, 0, &std::get<string_type>(*value._value) };
+				default:                                  return { _kind_t::STRUCTURED, false, 0, nullptr, &value,
+					std::numeric_limits<long double>::digits, &_node_equal<integer_type, floating_point_type> };
+				}
+			}
+			return { _kind_t::NOTHING };
+		}
+
+		// Rounds the number of an operand to the lesser precision of the two operands.
+		static long double _round(const _comparable& operand, const _comparable& other) {
+			const int digits = std::min(operand._digits, other._digits);
+			if (digits <= std::numeric_limits<float>::digits) return static_cast<float>(operand._number);
+			if (digits <= std::numeric_limits<double>::digits) return static_cast<double>(operand._number);
+			return operand._number;
+		}
+
+		static bool _equal(const _comparable& lhs, const _comparable& rhs) {
+			using _kind_t = typename _comparable::_kind_t;
+
+			if (lhs._kind != rhs._kind) return false;
+			switch (lhs._kind) {
+			case _kind_t::BOOLEAN:    return lhs._boolean == rhs._boolean;
+			case _kind_t::NUMBER:     return _round(lhs, rhs) == _round(rhs, lhs);
+			case _kind_t::STRING:     return *lhs._string == *rhs._string;
+			case _kind_t::STRUCTURED: return lhs._node == rhs._node || lhs._node_equal(lhs._node, rhs._node);
+			default:                  return true;
+			}
+		}
+
+		static bool _less(const _comparable& lhs, const _comparable& rhs) {
+			using _kind_t = typename _comparable::_kind_t;
+
+			if (lhs._kind != rhs._kind) return false;
+			if (lhs._kind == _kind_t::NUMBER) return _round(lhs, rhs) < _round(rhs, lhs);
+			if (lhs._kind == _kind_t::STRING) return *lhs._string < *rhs._string;
+			return false;
+		}
+
+		// Evaluates the filter expression against the current node.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		bool _test(const value_type<integer_type, floating_point_type, string_type>& root, const size_t expression_index,
+			const value_type<integer_type, floating_point_type, string_type>& current) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+			using _type_t = typename _expression::_type_t;
+
+			auto& expression = _expressions[expression_index];
+			switch (expression._type) {
+			case _type_t::OR:  return _test(root, expression._lhs, current) || _test(root, expression._rhs, current);
+			case _type_t::AND: return _test(root, expression._lhs, current) && _test(root, expression._rhs, current);
+			case _type_t::NOT: return !_test(root, expression._lhs, current);
+			case _type_t::EXISTS: {
+				auto& query = std::get<_query>(expression._left);
+				bool found = false;
+				auto on_match = [&found](const json_value&) {
+					found = true;
+					return false;
+				};
+				_walk(root, query._segments, 0, query._absolute ? root : current, on_match);
+				return found;
+			}
+			case _type_t::CALL:
+				return _call_matches(root, _calls[std::get<_call_index>(expression._left)._index], current);
+			default:
+				break;
+			}
+
+			auto lhs = _to_comparable<integer_type, floating_point_type>(_evaluate(root, expression._left, current));
+			auto rhs = _to_comparable<integer_type, floating_point_type>(_evaluate(root, expression._right, current));
+			switch (expression._type) {
+			case _type_t::EQUAL:         return _equal(lhs, rhs);
+			case _type_t::NOT_EQUAL:     return !_equal(lhs, rhs);
+			case _type_t::LESS:          return _less(lhs, rhs);
+			case _type_t::LESS_EQUAL:    return _less(lhs, rhs) || _equal(lhs, rhs);
+			case _type_t::GREATER:       return _less(rhs, lhs);
+			case _type_t::GREATER_EQUAL: return _less(rhs, lhs) || _equal(lhs, rhs);
+			default:                     return false;
+			}
+		}
+
+	public:
+		// Compiles the query, e.g. "$.store.book[?@.price < 10].title". Throws parsing_error if it is not a valid JSONPath query.
+		json_path(const _view_alias text) {
+			size_t position = 0;
+			_skip_blank(text, position);
+			_expect(text, position, "$");
+			_parse_segments(text, position, _segments);
+			_skip_blank(text, position);
+			if (position != text.size()) {
+				_throw_at(position);
+			}
+		}
+
+		// Compiles the query, e.g. "$.store.book[?@.price < 10].title". Throws parsing_error if it is not a valid JSONPath query.
+		json_path(const _char_alias* text) : json_path(_view_alias(text)) {}
+
+		// Returns every value within root which the query selects, in order, without copying any of them.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		[[nodiscard]] std::vector<const value_type<integer_type, floating_point_type, string_type>*> execute(
+			const value_type<integer_type, floating_point_type, string_type>& root) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			std::vector<const json_value*> results;
+			auto on_match = [&results](const json_value& match) {
+				results.push_back(&match);
+				return true;
+			};
+			_walk(root, _segments, 0, root, on_match);
+			return results;
+		}
+
+		// Returns the first value within root which the query selects, or nullptr if it selects none. Stops searching at the first match.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		[[nodiscard]] const value_type<integer_type, floating_point_type, string_type>* first(
+			const value_type<integer_type, floating_point_type, string_type>& root) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			const json_value* result = nullptr;
+			auto on_match = [&result](const json_value& match) {
+				result = &match;
+				return false;
+			};
+			_walk(root, _segments, 0, root, on_match);
+			return result;
+		}
+	};
+	// A set of JSON Pointers compiled into a trie, with which parse_text builds only the values they refer to.
+	template <string_concept string_type>
+	class projection {
+
+		// A node of the trie. If whole, the entire value is wanted, otherwise only the values of its children.
+		struct _node {
+			bool _whole = false;
+			std::vector<std::pair<typename json_pointer<string_type>::_token, size_t>> _children;
+		};
+
+		std::vector<_node> _nodes{ 1 };
+
+		// Keeps track of the line and character of the cursor, counting lazily since skipped values need no positions.
+		struct _position {
+			std::string_view::const_iterator _counted;
+			uint16_t _line = 1;
+			uint16_t _character = 1;
+
+			void _advance(const std::string_view::const_iterator to) {
+				for (; _counted < to; ++_counted) {
+					if (*_counted == '\n') {
+						++_line;
+						_character = 1;
+					}
+					else {
+						++_character;
+					}
+				}
+			}
+		};
+
+		[[noreturn]] static void _throw_at(const parsing_error::type_t type, _position& position, const std::string_view::const_iterator cursor) {
+			position._advance(cursor);
+			PUSH_TO_COUT("Unexpected token encountered at (" << position._line << ", " << position._character << ")\n");
+			throw parsing_error{ type, position._line, position._character };
+		}
+
+		static void _skip_white_space(const std::string_view source, std::string_view::const_iterator& cursor) {
+			while (cursor != source.cend() && (*cursor == ' ' || *cursor == '\n' || *cursor == '\t' || *cursor == '\r')) {
+				++cursor;
+			}
+		}
+
+		// Moves cursor past the string it is at, without unescaping it.
+		static void _skip_string(const std::string_view source, std::string_view::const_iterator& cursor, _position& position) {
+			const auto begin = cursor++;
+			for (;;) {
+				cursor = std::find_if(cursor, source.cend(), [](const char c) { return c == '\"' || c == '\\'; });
+				if (cursor == source.cend()) {
+					_throw_at(parsing_error::type_t::UNEXPECTED_SOURCE_END, position, begin);
+				}
+				if (*cursor == '\"') {
+					++cursor;
+					return;
+				}
+
+				// A reverse solidus escapes the character after it.
+				if (++cursor == source.cend()) {
+					_throw_at(parsing_error::type_t::UNEXPECTED_SOURCE_END, position, begin);
+				}
+				++cursor;
+			}
+		}
+
+		// Moves cursor past the key and colon of a member, from where the key is expected.
+		static void _skip_key(const std::string_view source, std::string_view::const_iterator& cursor, _position& position) {
+			_skip_white_space(source, cursor);
+			if (cursor == source.cend() || *cursor != '\"') {
+				_throw_at(cursor == source.cend() ? parsing_error::type_t::UNEXPECTED_SOURCE_END : parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+			}
+			_skip_string(source, cursor, position);
+			_skip_white_space(source, cursor);
+			if (cursor == source.cend() || *cursor != ':') {
+				_throw_at(cursor == source.cend() ? parsing_error::type_t::UNEXPECTED_SOURCE_END : parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+			}
+			++cursor;
+		}
+
+		// Moves cursor past literal, which it is at, and which must end there, or throws UNKNOWN_TOKEN as the tokenizer does.
+		static void _skip_literal(const std::string_view source, std::string_view::const_iterator& cursor, _position& position, const std::string_view literal) {
+			const auto end = static_cast<size_t>(source.cend() - cursor) < literal.size() ? source.cend() : cursor + literal.size();
+			if (std::string_view(cursor, end) != literal || (end != source.cend() && !_is_delimiter(*end))) {
+				_throw_at(parsing_error::type_t::UNKNOWN_TOKEN, position, cursor);
+			}
+			cursor = end;
+		}
+
+		static bool _is_delimiter(const char c) {
+			return c == ',' || c == ']' || c == '}' || c == ':' || c == '[' || c == '{' || c == ' ' || c == '\n' || c == '\t' || c == '\r';
+		}
+
+		// Moves cursor past the value it is at, checking its structure as the full parser would: brackets must match, members and elements
+		// must be separated by commas, keys must be strings followed by colons, and scalars must be true, false, null, strings or numbers.
+		// Nothing is converted, so strings are not unescaped, and numbers are only checked to consist of the characters of numbers.
+		static void _skip_value(const std::string_view source, std::string_view::const_iterator& cursor, _position& position) {
+			// The closing brackets of the containers the cursor is within, innermost last. Held within the string itself up to a small depth.
+			std::string closers;
+			for (;;) {
+				// At a value.
+				_skip_white_space(source, cursor);
+				if (cursor == source.cend()) {
+					_throw_at(parsing_error::type_t::UNEXPECTED_SOURCE_END, position, cursor);
+				}
+				switch (*cursor) {
+				case '\"':
+					_skip_string(source, cursor, position);
+					break;
+				case '[': case '{': {
+					const char closer = *cursor == '[' ? ']' : '}';
+					++cursor;
+					_skip_white_space(source, cursor);
+					if (cursor != source.cend() && *cursor == closer) {
+						++cursor;
+						break;
+					}
+					closers.push_back(closer);
+					if (closer == '}') {
+						_skip_key(source, cursor, position);
+					}
+					continue;
+				}
+				case 't':
+					_skip_literal(source, cursor, position, "true");
+					break;
+				case 'f':
+					_skip_literal(source, cursor, position, "false");
+					break;
+				case 'n':
+					_skip_literal(source, cursor, position, "null");
+					break;
+				case '0': case '1': case '2': case '3': case '4': case '5': case '6': case '7':
+				case '8': case '9': case '-': {
+					const auto begin = cursor;
+					cursor = std::find_if_not(cursor, source.cend(), [](const char c) {
+						return ('0' <= c && c <= '9') || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+					});
+					if (cursor != source.cend() && !_is_delimiter(*cursor)) {
+						_throw_at(parsing_error::type_t::UNKNOWN_TOKEN, position, begin);
+					}
+					break;
+				}
+				case ']': case '}': case ',': case ':':
+					_throw_at(parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+				default:
+					_throw_at(parsing_error::type_t::UNKNOWN_TOKEN, position, cursor);
+				}
+
+				// After a value, which either is followed by another within the same container, or ends containers.
+				for (;;) {
+					if (closers.empty()) {
+						return;
+					}
+					_skip_white_space(source, cursor);
+					if (cursor == source.cend()) {
+						_throw_at(parsing_error::type_t::UNEXPECTED_SOURCE_END, position, cursor);
+					}
+					if (*cursor == closers.back()) {
+						++cursor;
+						closers.pop_back();
+						continue;
+					}
+					if (*cursor != ',') {
+						_throw_at(parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+					}
+					++cursor;
+					if (closers.back() == '}') {
+						_skip_key(source, cursor, position);
+					}
+					break;
+				}
+			}
+		}
+
+		// Returns the child of node which the key or index refers to, if any.
+		const _node* _child(const _node& node, const std::string_view raw_key, _position& position, const std::string_view::const_iterator key_begin) const {
+			if constexpr (std::is_same_v<string_type, std::string>) {
+				if (raw_key.find('\\') == std::string_view::npos) {
+					auto it = std::find_if(node._children.cbegin(), node._children.cend(), [raw_key](auto& child) { return child.first._key == raw_key; });
+					return it != node._children.cend() ? &_nodes[it->second] : nullptr;
+				}
+			}
+			position._advance(key_begin);
+			const auto key = _string_handler::_parse_string<string_type>(raw_key, position._line, position._character);
+			auto it = std::find_if(node._children.cbegin(), node._children.cend(), [&key](auto& child) { return child.first._key == key; });
+			return it != node._children.cend() ? &_nodes[it->second] : nullptr;
+		}
+
+		// Builds the part of the value at cursor which node selects, and moves cursor past the value.
+		// Returns nothing if the value was not a container, but node only selects some of its children.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		std::optional<value_type<integer_type, floating_point_type, string_type>> _parse(const std::string_view source, std::string_view::const_iterator& cursor,
+			const _node& node, _position& position, std::vector<_tokenizer::_token>& token_sequence) const {
+			using json_value = value_type<integer_type, floating_point_type, string_type>;
+
+			if (node._whole) {
+				const auto begin = cursor;
+				_skip_value(source, cursor, position);
+				position._advance(begin);
+				token_sequence.clear();
+				uint16_t line = position._line;
+				uint16_t character = position._character;
+				_tokenizer::_tokenize(std::string_view(begin, cursor), token_sequence, line, character, true);
+				return json_value::_parse_tokens(token_sequence);
+			}
+
+			if (cursor != source.cend() && *cursor == '{') {
+				typename json_value::_object_alias obj;
+				++cursor;
+				_skip_white_space(source, cursor);
+				if (cursor != source.cend() && *cursor == '}') {
+					++cursor;
+					json_value value;
+					value._hold(std::move(obj));
+					return value;
+				}
+				for (;;) {
+					if (cursor == source.cend() || *cursor != '\"') {
+						_throw_at(cursor == source.cend() ? parsing_error::type_t::UNEXPECTED_SOURCE_END : parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+					}
+					const auto key_begin = cursor;
+					_skip_string(source, cursor, position);
+					const std::string_view raw_key(key_begin + 1, cursor - 1);
+					_skip_white_space(source, cursor);
+					if (cursor == source.cend() || *cursor != ':') {
+						_throw_at(parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+					}
+					++cursor;
+					_skip_white_space(source, cursor);
+
+					if (auto child = _child(node, raw_key, position, key_begin + 1)) {
+						position._advance(key_begin + 1);
+						auto key = _string_handler::_parse_string<string_type>(raw_key, position._line, position._character);
+						if (auto element = _parse<integer_type, floating_point_type>(source, cursor, *child, position, token_sequence)) {
+							obj.insert_or_assign(std::move(key), std::move(*element));
+						}
+					}
+					else {
+						_skip_value(source, cursor, position);
+					}
+
+					_skip_white_space(source, cursor);
+					if (cursor != source.cend() && *cursor == ',') {
+						++cursor;
+						_skip_white_space(source, cursor);
+						continue;
+					}
+					if (cursor != source.cend() && *cursor == '}') {
+						++cursor;
+						json_value value;
+						value._hold(std::move(obj));
+						return value;
+					}
+					_throw_at(cursor == source.cend() ? parsing_error::type_t::UNEXPECTED_SOURCE_END : parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+				}
+			}
+
+			if (cursor != source.cend() && *cursor == '[') {
+				typename json_value::_array_alias arr;
+				++cursor;
+				_skip_white_space(source, cursor);
+				if (cursor != source.cend() && *cursor == ']') {
+					++cursor;
+					json_value value;
+					value._hold(std::move(arr));
+					return value;
+				}
+				for (size_t index = 0;; ++index) {
+					auto child = std::find_if(node._children.cbegin(), node._children.cend(), [index](auto& child) { return child.first._index == index; });
+					if (child != node._children.cend()) {
+						if (auto element = _parse<integer_type, floating_point_type>(source, cursor, _nodes[child->second], position, token_sequence)) {
+							arr.resize(index + 1);
+							arr[index] = std::move(*element);
+						}
+					}
+					else {
+						_skip_value(source, cursor, position);
+					}
+
+					_skip_white_space(source, cursor);
+					if (cursor != source.cend() && *cursor == ',') {
+						++cursor;
+						_skip_white_space(source, cursor);
+						continue;
+					}
+					if (cursor != source.cend() && *cursor == ']') {
+						++cursor;
+						json_value value;
+						value._hold(std::move(arr));
+						return value;
+					}
+					_throw_at(cursor == source.cend() ? parsing_error::type_t::UNEXPECTED_SOURCE_END : parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+				}
+			}
+
+			_skip_value(source, cursor, position);
+			return {};
+		}
+
+		// Parses the whole source, which must hold exactly one value.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		value_type<integer_type, floating_point_type, string_type> _parse_text(const std::string_view source) const {
+			_position position{ source.cbegin() };
+			std::vector<_tokenizer::_token> token_sequence;
+			auto cursor = source.cbegin();
+			_skip_white_space(source, cursor);
+			if (cursor == source.cend()) {
+				PUSH_TO_COUT("Source was empty!\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+
+			auto value = _parse<integer_type, floating_point_type>(source, cursor, _nodes.front(), position, token_sequence);
+
+			_skip_white_space(source, cursor);
+			if (cursor != source.cend()) {
+				_throw_at(parsing_error::type_t::UNEXPECTED_TOKEN, position, cursor);
+			}
+			return value ? std::move(*value) : value_type<integer_type, floating_point_type, string_type>();
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend value_type<I, F, S> parse_text(const std::string_view, const projection<S>&);
+
+	public:
+		// Compiles the pointers into a trie. The values they refer to, and their ancestors, are what parse_text will build.
+		projection(const std::span<const json_pointer<string_type>> pointers) {
+			for (auto& pointer : pointers) {
+				size_t node = 0;
+				for (auto& token : pointer._tokens) {
+					auto& children = _nodes[node]._children;
+					auto it = std::find_if(children.cbegin(), children.cend(), [&token](auto& child) { return child.first._key == token._key; });
+					if (it != children.cend()) {
+						node = it->second;
+						continue;
+					}
+					children.emplace_back(token, _nodes.size());
+					node = _nodes.size();
+					_nodes.emplace_back();
+				}
+				_nodes[node]._whole = true;
+			}
+		}
+
+		// Compiles the pointers into a trie. The values they refer to, and their ancestors, are what parse_text will build.
+		projection(const std::initializer_list<json_pointer<string_type>> pointers)
+			: projection(std::span<const json_pointer<string_type>>(pointers.begin(), pointers.size())) {}
+	};
+
+	// Parses JSON source text, but only builds the values selected by the projection. Arrays keep the positions of their selected elements,
+	// with unselected elements before them as null. Values which are not selected are skipped without being unescaped or converted.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	[[nodiscard]] value_type<integer_type, floating_point_type, string_type> parse_text(const std::string_view source, const projection<string_type>& selection) {
+		auto value = selection.template _parse_text<integer_type, floating_point_type>(source);
+
+		PUSH_TO_COUT("Source was successfully parsed.\n");
+
+		return value;
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	// Tokenizes a stream or a buffer chunk by chunk, only as far as the tokens are asked for, and parses values out of the tokens.
+	class _token_stream {
+		static constexpr size_t _chunk_size = size_t(1) << 20;
+
+		// Either a stream, whose chunks are read into _buffer, or a whole buffer, of which windows are tokenized in place.
+		// What is left of _buffer after tokenizing it is the beginning of a single token, of length _unfinished.
+		std::istream* _stream = nullptr;
+		std::string _buffer;
+		size_t _unfinished = 0;
+		std::string_view _source;
+		size_t _offset = 0;
+		size_t _window = _chunk_size;
+		bool _exhausted = false;
+
+		// Tokens before _cursor are consumed, and are dropped once they make up half of the sequence.
+		std::vector<_tokenizer::_token> _tokens;
+		size_t _cursor = 0;
+		uint16_t _line = 1;
+		uint16_t _character = 1;
+
+		_token_stream(std::istream& stream) : _stream(&stream) {}
+		_token_stream(const std::string_view source) : _source(source) {}
+
+		// Starts over on source, keeping the capacity of the token sequence.
+		void _reset(const std::string_view source) {
+			_stream = nullptr;
+			_buffer.clear();
+			_unfinished = 0;
+			_source = source;
+			_offset = 0;
+			_window = _chunk_size;
+			_exhausted = false;
+			_tokens.clear();
+			_cursor = 0;
+			_line = 1;
+			_character = 1;
+		}
+
+		// Drops the consumed tokens, once they make up half of the sequence. Indices into the sequence are invalidated.
+		void _compact() {
+			if (_cursor != 0 && _cursor * 2 >= _tokens.size()) {
+				_tokens.erase(_tokens.begin(), _tokens.begin() + _cursor);
+				_cursor = 0;
+			}
+		}
+
+		// Tokenizes the next chunk. A token which continues past the chunk is carried over to the next one, and once a token is longer
+		// than what is carried over, the chunks after it are only tokenized once the buffer has doubled, as the window on a buffer widens,
+		// so that a token which straddles many chunks is not scanned from its beginning for each of them.
+		void _fill() {
+			if (_stream) {
+				const size_t carry = _buffer.size();
+				_buffer.resize(carry + _chunk_size);
+				_stream->read(_buffer.data() + carry, _chunk_size);
+				if (_stream->bad()) {
+					PUSH_TO_COUT("Could not read stream.\n");
+					throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+				}
+				_buffer.resize(carry + static_cast<size_t>(_stream->gcount()));
+				_exhausted = _stream->eof();
+				if (_exhausted || _buffer.size() >= 2 * _unfinished) {
+					_buffer.erase(0, _tokenizer::_tokenize(_buffer, _tokens, _line, _character, _exhausted));
+					_unfinished = _buffer.size();
+				}
+				return;
+			}
+
+			const size_t window = std::min(_window, _source.size() - _offset);
+			_exhausted = _offset + window == _source.size();
+			const size_t consumed = _tokenizer::_tokenize(_source.substr(_offset, window), _tokens, _line, _character, _exhausted);
+
+			// A token longer than the window needs a wider window.
+			_window = consumed == 0 ? _window * 2 : _chunk_size;
+			_offset += consumed;
+		}
+
+		// Returns whether there is a token at index, tokenizing as far as needed to find out.
+		bool _has(const size_t index) {
+			while (index >= _tokens.size()) {
+				if (_exhausted) {
+					return false;
+				}
+				_fill();
+			}
+			return true;
+		}
+
+		// Returns the next unconsumed token, if there is one.
+		const _tokenizer::_token* _peek() {
+			return _has(_cursor) ? &_tokens[_cursor] : nullptr;
+		}
+
+		// Returns the index one past the value which begins at index, tokenizing as far as needed.
+		size_t _value_end(size_t index) {
+			size_t depth = 0;
+			do {
+				if (!_has(index)) {
+					PUSH_TO_COUT("Source ended unexpectedly before a value was completely parsed.\n");
+					throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+				}
+				switch (_tokens[index]._type) {
+				case _tokenizer::_token::_type_t::LEFT_SQUARE_BRACKET:
+				case _tokenizer::_token::_type_t::LEFT_CURLY_BRACKET:
+					++depth;
+					break;
+				case _tokenizer::_token::_type_t::RIGHT_SQUARE_BRACKET:
+				case _tokenizer::_token::_type_t::RIGHT_CURLY_BRACKET:
+					if (depth != 0) {
+						--depth;
+					}
+					break;
+				default:
+					break;
+				}
+				++index;
+			} while (depth != 0);
+			return index;
+		}
+
+		// Parses the value at the next unconsumed token, and consumes its tokens.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		value_type<integer_type, floating_point_type, string_type> _take_value() {
+			_compact();
+			const size_t end = _value_end(_cursor);
+			auto cursor = _tokens.cbegin() + _cursor;
+			auto value = value_type<integer_type, floating_point_type, string_type>(cursor, _tokens.cbegin() + end);
+			_cursor = cursor - _tokens.cbegin();
+			return value;
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class array_reader;
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend class document_stream;
+	};
+
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	// An input iterator over the values of a reader, which it fetches one at a time with next().
+	template <typename reader_type, typename element_type>
+	class _input_iterator {
+		reader_type* _reader;
+		mutable std::optional<element_type> _element;
+
+	public:
+		using iterator_concept = std::input_iterator_tag;
+		using difference_type = std::ptrdiff_t;
+		using value_type = element_type;
+
+		_input_iterator(reader_type& reader) : _reader(&reader), _element(reader.next()) {}
+
+		element_type& operator*() const {
+			return *_element;
+		}
+
+		_input_iterator& operator++() {
+			_element = _reader->next();
+			return *this;
+		}
+
+		void operator++(int) {
+			++*this;
+		}
+
+		friend bool operator==(const _input_iterator& it, std::default_sentinel_t) {
+			return !it._element;
+		}
+	};
+
+	// Reads the elements of a JSON file which holds a single array, one element at a time.
+	// The file is read in chunks as elements are asked for, so memory is bounded by the largest element rather than by the file.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	class array_reader {
+		std::ifstream _file;
+		_token_stream _tokens;
+		bool _started = false;
+		bool _finished = false;
+
+		// Ends the array, which must also be the end of the file.
+		void _finish() {
+			_finished = true;
+			if (auto token = _tokens._peek()) {
+				PUSH_TO_COUT("Unexpected token at (" << token->_line << ", " << token->_character << "), the source already had a value but continued.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, token->_line, token->_character };
+			}
+		}
+
+		// Returns the next token, which must exist.
+		const _tokenizer::_token& _expect_token() {
+			auto token = _tokens._peek();
+			if (!token) {
+				PUSH_TO_COUT("Source ended unexpectedly before an array was completely parsed.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_SOURCE_END, {}, {} };
+			}
+			return *token;
+		}
+
+	public:
+		using iterator = _input_iterator<array_reader, value_type<integer_type, floating_point_type, string_type>>;
+
+		// Opens the JSON file at path, but reads none of it yet.
+		array_reader(const std::filesystem::path path) : _tokens(_file) {
+			if (path.extension() != ".json") {
+				PUSH_TO_COUT("Unexpected file extension of path: " << path << ", expected .json\n");
+				throw parsing_error{ parsing_error::type_t::INCORRECT_FILE_EXTENSION, {}, {} };
+			}
+
+			std::error_code ec;
+
+			if (!std::filesystem::exists(path, ec)) {
+				PUSH_TO_COUT("No file found at path: " << path << "\nstd::filesystem::exists gave error code " << ec.value() << ':' << ec.message() << '\n');
+				throw parsing_error{ parsing_error::type_t::FILE_NOT_FOUND, {}, {} };
+			};
+
+			PUSH_TO_COUT("Reading file: " << path << '\n');
+			_file.open(path, std::ios::binary);
+
+			if (!_file.is_open()) {
+				PUSH_TO_COUT("Could not read file.\n");
+				throw parsing_error{ parsing_error::type_t::FILE_READ_ERROR, {}, {} };
+			}
+		}
+
+		array_reader(const array_reader&) = delete;
+		array_reader& operator=(const array_reader&) = delete;
+
+		// Returns the next element of the array, or nothing once the array has ended.
+		[[nodiscard]] std::optional<value_type<integer_type, floating_point_type, string_type>> next() {
+			if (_finished) {
+				return {};
+			}
+
+			auto* token = &_expect_token();
+			if (!_started) {
+				if (token->_type != _tokenizer::_token::_type_t::LEFT_SQUARE_BRACKET) {
+					PUSH_TO_COUT("Unexpected token at (" << token->_line << ", " << token->_character << "), expected '['.\n");
+					throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, token->_line, token->_character };
+				}
+				_started = true;
+				++_tokens._cursor;
+				if (_expect_token()._type == _tokenizer::_token::_type_t::RIGHT_SQUARE_BRACKET) {
+					++_tokens._cursor;
+					_finish();
+					return {};
+				}
+			}
+			else if (token->_type == _tokenizer::_token::_type_t::RIGHT_SQUARE_BRACKET) {
+				++_tokens._cursor;
+				_finish();
+				return {};
+			}
+			else if (token->_type == _tokenizer::_token::_type_t::COMMA) {
+				++_tokens._cursor;
+			}
+			else {
+				PUSH_TO_COUT("Unexpected token at (" << token->_line << ", " << token->_character << "), expected ',' or ']'.\n");
+				throw parsing_error{ parsing_error::type_t::UNEXPECTED_TOKEN, token->_line, token->_character };
+			}
+
+			return _tokens._take_value<integer_type, floating_point_type, string_type>();
+		}
+
+		[[nodiscard]] iterator begin() {
+			return iterator(*this);
+		}
+
+		[[nodiscard]] std::default_sentinel_t end() const {
+			return {};
+		}
+	};
+
+	// Parses a sequence of JSON values which follow each other in one buffer or stream, with or without whitespace between them, such as {...}{...}[...].
+	// The source is tokenized in chunks as values are asked for, and the token sequence is reused from one value to the next.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	class document_stream {
+		_token_stream _tokens;
+
+	public:
+		using iterator = _input_iterator<document_stream, value_type<integer_type, floating_point_type, string_type>>;
+
+		// Parses the values of source, which must outlive the document_stream.
+		document_stream(const std::string_view source) : _tokens(source) {}
+
+		// Parses the values read from stream, which must outlive the document_stream.
+		document_stream(std::istream& stream) : _tokens(stream) {}
+
+		document_stream(const document_stream&) = delete;
+		document_stream& operator=(const document_stream&) = delete;
+
+		// Starts over on source, reusing the scratch state of the previous source.
+		void reset(const std::string_view source) {
+			_tokens._reset(source);
+		}
+
+		// Returns the next value of the source, or nothing once the source has ended.
+		[[nodiscard]] std::optional<value_type<integer_type, floating_point_type, string_type>> next() {
+			if (!_tokens._peek()) {
+				return {};
+			}
+			return _tokens._take_value<integer_type, floating_point_type, string_type>();
+		}
+
+		[[nodiscard]] iterator begin() {
+			return iterator(*this);
+		}
+
+		[[nodiscard]] std::default_sentinel_t end() const {
+			return {};
+		}
+	};
+
+	// Writes JSON one call at a time, such as begin_object(), key("a"), value(1), end_object(), without building a value_type.
+	// The output is formatted as by operator<<, and is written to a stream or appended to a string as it is produced, so the writer itself only holds its nesting.
+	// Unbalanced calls, such as a key outside of an object, a value without a key within one, or ending the wrong container, throw interface_misuse::INCORRECT_TYPE.
+	template <string_concept string_type>
+	class stream_writer {
+		using _char_t = typename string_type::value_type;
+
+		// An open container, and whether anything has been written to it yet.
+		struct _frame {
+			bool _object;
+			bool _empty;
+		};
+
+		std::ostream* _stream = nullptr;
+		std::string* _buffer = nullptr;
+		std::vector<_frame> _frames;
+		bool _has_key = false;
+		bool _has_root = false;
+
+		void _emit(const std::string_view text) {
+			if (_stream) {
+				_stream->write(text.data(), static_cast<std::streamsize>(text.size()));
+			}
+			else {
+				_buffer->append(text);
+			}
+		}
+
+		void _indent(const size_t depth) {
+			for (size_t i = 0; i < depth; ++i) _emit("\t");
+		}
+
+		// Writes whatever must precede a value at the current position. Values at the top level are separated by newlines.
+		void _before_value() {
+			if (_frames.empty()) {
+				if (_has_root) {
+					_emit("\n");
+				}
+				_has_root = true;
+				return;
+			}
+
+			auto& frame = _frames.back();
+			if (frame._object) {
+				if (!_has_key) {
+					throw interface_misuse::INCORRECT_TYPE;
+				}
+				_has_key = false;
+				return;
+			}
+			_emit(frame._empty ? "\n" : ",\n");
+			frame._empty = false;
+			_indent(_frames.size());
+		}
+
+		void _begin(const bool object) {
+			_before_value();
+			_emit(object ? "{" : "[");
+			_frames.push_back({ object, true });
+		}
+
+		void _end(const bool object) {
+			if (_frames.empty() || _frames.back()._object != object || _has_key) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			const bool empty = _frames.back()._empty;
+			_frames.pop_back();
+			if (!empty) {
+				_emit("\n");
+				_indent(_frames.size());
+			}
+			_emit(object ? "}" : "]");
+		}
+
+	public:
+		// Writes to stream, which must outlive the writer.
+		stream_writer(std::ostream& stream) : _stream(&stream) {}
+
+		// Appends to buffer, which must outlive the writer.
+		stream_writer(std::string& buffer) : _buffer(&buffer) {}
+
+		stream_writer& begin_object() {
+			_begin(true);
+			return *this;
+		}
+
+		stream_writer& end_object() {
+			_end(true);
+			return *this;
+		}
+
+		stream_writer& begin_array() {
+			_begin(false);
+			return *this;
+		}
+
+		stream_writer& end_array() {
+			_end(false);
+			return *this;
+		}
+
+		// Writes the key of the next value of the current object.
+		stream_writer& key(const std::basic_string_view<_char_t> name) {
+			if (_frames.empty() || !_frames.back()._object || _has_key) {
+				throw interface_misuse::INCORRECT_TYPE;
+			}
+			auto& frame = _frames.back();
+			_emit(frame._empty ? "\n" : ",\n");
+			frame._empty = false;
+			_indent(_frames.size());
+			_emit("\"");
+			_emit(_string_handler::_format_string<string_type>(name));
+			_emit("\": ");
+			_has_key = true;
+			return *this;
+		}
+
+		stream_writer& value(std::nullptr_t) {
+			_before_value();
+			_emit("null");
+			return *this;
+		}
+
+		stream_writer& value(const bool boolean) {
+			_before_value();
+			_emit(boolean ? "true" : "false");
+			return *this;
+		}
+
+		template <std::integral integer_type>
+		requires (!std::is_same_v<integer_type, bool>) && (!std::is_same_v<integer_type, _char_t>)
+		stream_writer& value(const integer_type integer) {
+			_before_value();
+			_emit(_string_handler::_format_integer(integer));
+			return *this;
+		}
+
+		template <std::floating_point floating_point_type>
+		stream_writer& value(const floating_point_type floating_point) {
+			_before_value();
+			_emit(_string_handler::_format_floating_point(floating_point));
+			return *this;
+		}
+
+		stream_writer& value(const std::basic_string_view<_char_t> string) {
+			_before_value();
+			_emit("\"");
+			_emit(_string_handler::_format_string<string_type>(string));
+			_emit("\"");
+			return *this;
+		}
+
+		stream_writer& value(const _char_t* string) {
+			return value(std::basic_string_view<_char_t>(string));
+		}
+
+		// Writes a whole value_type at the current position.
+		template <std::integral integer_type, std::floating_point floating_point_type>
+		stream_writer& value(const value_type<integer_type, floating_point_type, string_type>& subtree) {
+			_before_value();
+			if (_stream) {
+				subtree._write_to_ostream(*_stream, _frames.size());
+			}
+			else {
+				std::ostringstream stream;
+				subtree._write_to_ostream(stream, _frames.size());
+				_emit(stream.view());
+			}
+			return *this;
+		}
+
+		// Returns whether a value has been written and every container which has begun has also ended.
+		[[nodiscard]] bool complete() const {
+			return _frames.empty() && _has_root;
+		}
+	};
+
+#ifdef EULERISTIC_JSON_PARALLEL_WRITES
+	// A class which hides implementation details so that the API is cleaner.
+	// Basically: DO NOT USE. Unless you really want to. 
+	// Serializes a value by splitting it into subtrees which are rendered on separate threads, and writes the rendered pieces in order.
+	class _parallel_writer {
+
+		// Either structural text between subtrees, or a run of values to render into _text.
+		// A run of values is either a single value which is written bare, or consecutive elements or members of a container, written with their separators and keys at indentation level _depth.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		struct _piece {
+			std::string _text;
+			std::vector<std::pair<const string_type*, const value_type<integer_type, floating_point_type, string_type>*>> _values;
+			size_t _depth;
+			bool _bare;
+			bool _first;
+		};
+
+		// Subtrees are not split below this many values.
+		static constexpr size_t _minimum_weight = 4096;
+
+		// Returns the number of values within value, including itself, but stops counting once the count exceeds limit.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static size_t _weight(const value_type<integer_type, floating_point_type, string_type>& value, const size_t limit = std::numeric_limits<size_t>::max()) {
+			using value_t = value_type<integer_type, floating_point_type, string_type>;
+			size_t weight = 1;
+			if (value._type == value_t::_type_t::ARRAY) {
+				for (auto& element : value._array()) {
+					if (weight > limit) break;
+					weight += _weight(element, limit - weight);
+				}
+			}
+			else if (value._type == value_t::_type_t::OBJECT) {
+				for (auto& [key, element] : value._object()) {
+					if (weight > limit) break;
+					weight += _weight(element, limit - weight);
+				}
+			}
+			return weight;
+		}
+
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static void _append(std::vector<_piece<integer_type, floating_point_type, string_type>>& pieces, const std::string_view text) {
+			if (pieces.empty() || !pieces.back()._values.empty()) {
+				pieces.push_back({ {}, {}, 0, false, false });
+			}
+			pieces.back()._text.append(text);
+		}
+
+		// Splits value into pieces of about target values each. Containers heavier than target are split into their elements or members,
+		// where runs of light ones are gathered into one piece, and the brackets, keys and separators around heavy ones are written as in _write_to_ostream.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static void _split(const value_type<integer_type, floating_point_type, string_type>& value, const size_t depth, const size_t target,
+			std::vector<_piece<integer_type, floating_point_type, string_type>>& pieces) {
+
+			using value_t = value_type<integer_type, floating_point_type, string_type>;
+			const bool array = value._type == value_t::_type_t::ARRAY;
+			if ((!array && value._type != value_t::_type_t::OBJECT) || _weight(value, target) <= target) {
+				pieces.push_back({ {}, { { nullptr, &value } }, depth, true, false });
+				return;
+			}
+
+			bool first = true;
+			size_t run_weight = 0;
+			bool in_run = false;
+			auto split_element = [&](const string_type* key, const value_t& element) {
+				const size_t weight = _weight(element, target);
+				if (weight > target) {
+					in_run = false;
+					_append(pieces, first ? "\n" : ",\n");
+					_append(pieces, std::string(depth + 1, '\t'));
+					if (key) {
+						_append(pieces, "\"" + _string_handler::_format_string<string_type>(*key) + "\": ");
+					}
+					_split(element, depth + 1, target, pieces);
+				}
+				else {
+					if (!in_run || run_weight + weight > target) {
+						pieces.push_back({ {}, {}, depth + 1, false, first });
+						in_run = true;
+						run_weight = 0;
+					}
+					pieces.back()._values.emplace_back(key, &element);
+					run_weight += weight;
+				}
+				first = false;
+			};
+
+			_append(pieces, array ? "[" : "{");
+			if (array) {
+				for (auto& element : value._array()) {
+					split_element(nullptr, element);
+				}
+			}
+			else {
+				for (auto& [key, element] : value._object()) {
+					split_element(&key, element);
+				}
+			}
+			_append(pieces, "\n");
+			_append(pieces, std::string(depth, '\t'));
+			_append(pieces, array ? "]" : "}");
+		}
+
+		// Renders the values of a piece into its text.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static void _render(_piece<integer_type, floating_point_type, string_type>& piece) {
+			std::ostringstream stream;
+			if (piece._bare) {
+				piece._values.front().second->_write_to_ostream(stream, piece._depth, false);
+			}
+			else {
+				bool first = piece._first;
+				for (auto& [key, value] : piece._values) {
+					stream << (first ? "\n" : ",\n");
+					for (size_t i = 0; i < piece._depth; ++i) stream << '\t';
+					if (key) {
+						stream << '\"' << _string_handler::_format_string<string_type>(*key) << "\": ";
+					}
+					value->_write_to_ostream(stream, piece._depth, false);
+					first = false;
+				}
+			}
+			piece._text = std::move(stream).str();
+		}
+
+		// Renders the subtree pieces on threads threads, and rethrows the first error of any of them.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static void _render(std::vector<_piece<integer_type, floating_point_type, string_type>>& pieces, const unsigned threads) {
+			std::atomic<size_t> next = 0;
+			std::exception_ptr error;
+			std::mutex error_mutex;
+
+			auto work = [&]() {
+				for (size_t index = next++; index < pieces.size(); index = next++) {
+					auto& piece = pieces[index];
+					if (piece._values.empty()) {
+						continue;
+					}
+					try {
+						_render(piece);
+					}
+					catch (...) {
+						std::lock_guard lock(error_mutex);
+						if (!error) {
+							error = std::current_exception();
+						}
+						next = pieces.size();
+					}
+				}
+			};
+
+			std::vector<std::thread> workers;
+			for (unsigned i = 1; i < threads; ++i) {
+				workers.emplace_back(work);
+			}
+			work();
+			for (auto& worker : workers) {
+				worker.join();
+			}
+
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+
+		// Writes the pieces to the file at path as options asks, as write_to_file does, gathering many pieces into each write.
+		template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+		static void _write(const std::vector<_piece<integer_type, floating_point_type, string_type>>& pieces, const std::filesystem::path& path, const write_options& options) {
+
+#if defined(EULERISTIC_JSON_ZLIB) || defined(EULERISTIC_JSON_ZSTD)
+			if (auto codec = _compression::_codec_of(path)) {
+				_compression::_compressing_streambuf buffer(path, *codec);
+				for (auto& piece : pieces) {
+					buffer.sputn(piece._text.data(), static_cast<std::streamsize>(piece._text.size()));
+				}
+				buffer._finish();
+				return;
+			}
+#endif //EULERISTIC_JSON_ZLIB || EULERISTIC_JSON_ZSTD
+
+			std::vector<std::string_view> texts;
+			texts.reserve(pieces.size());
+			for (auto& piece : pieces) {
+				texts.push_back(piece._text);
+			}
+			_buffered_file file(path, options);
+			file._write_gathered(texts);
+			file._finish();
+		}
+
+		// Friends
+		template <std::integral I, std::floating_point F, string_concept S>
+		friend void write_to_file_parallel(const value_type<I, F, S>&, const std::filesystem::path, const write_options&, unsigned);
+	};
+
+	// Writes value to a file at path as JSON, like write_to_file, but renders large subtrees on threads threads at once.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void write_to_file_parallel(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path, unsigned threads) {
+		write_to_file_parallel(value, path, write_options{}, threads);
+	}
+
+	// Writes value to a file at path as JSON, as options asks, like write_to_file, but renders large subtrees on threads threads at once.
+	template <std::integral integer_type, std::floating_point floating_point_type, string_concept string_type>
+	void write_to_file_parallel(const value_type<integer_type, floating_point_type, string_type>& value, const std::filesystem::path path, const write_options& options, unsigned threads) {
+
+		PUSH_TO_COUT("Writing to file: " << path << '\n');
+
+		if (threads == 0) {
+			threads = std::max(1u, std::thread::hardware_concurrency());
+		}
+
+		// Aim for several pieces per thread, so that threads which finish early may take over.
+		const size_t target = threads == 1 ? std::numeric_limits<size_t>::max()
+			: std::max(_parallel_writer::_minimum_weight, _parallel_writer::_weight(value) / (size_t(threads) * 8));
+		std::vector<_parallel_writer::_piece<integer_type, floating_point_type, string_type>> pieces;
+		_parallel_writer::_split(value, 0, target, pieces);
+		_parallel_writer::_render(pieces, threads);
+		_parallel_writer::_write(pieces, path, options);
+
+		PUSH_TO_COUT("Successfully wrote to file!\n");
+	}
+#endif //EULERISTIC_JSON_PARALLEL_WRITES
+}
+
+// Hashes values by their structure, as euleristic::json::hash does, so that they may be keys of unordered containers.
+template <std::integral integer_type, std::floating_point floating_point_type, euleristic::json::string_concept string_type>
+struct std::hash<euleristic::json::value_type<integer_type, floating_point_type, string_type>> {
+	[[nodiscard]] size_t operator()(const euleristic::json::value_type<integer_type, floating_point_type, string_type>& value) const {
+		return euleristic::json::hash(value);
+	}
+};
+
+#ifdef EULERISTIC_JSON_ALLOCATION_HOOKS_IMPLEMENTATION
+// The global allocation operators, replaced so that euleristic::json::allocation_counter sees every allocation.
+void* operator new(size_t size) { return euleristic::json::_allocation_hooks::_allocate_or_throw(size, alignof(std::max_align_t)); }
+void* operator new[](size_t size) { return euleristic::json::_allocation_hooks::_allocate_or_throw(size, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment) { return euleristic::json::_allocation_hooks::_allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment) { return euleristic::json::_allocation_hooks::_allocate_or_throw(size, static_cast<size_t>(alignment)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return euleristic::json::_allocation_hooks::_allocate(size ? size : 1, alignof(std::max_align_t)); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return euleristic::json::_allocation_hooks::_allocate(size ? size : 1, alignof(std::max_align_t)); }
+void* operator new(size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return euleristic::json::_allocation_hooks::_allocate(size ? size : 1, static_cast<size_t>(alignment)); }
+void* operator new[](size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept { return euleristic::json::_allocation_hooks::_allocate(size ? size : 1, static_cast<size_t>(alignment)); }
+void operator delete(void* memory) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete[](void* memory) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete(void* memory, size_t) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete[](void* memory, size_t) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete(void* memory, size_t, std::align_val_t) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { euleristic::json::_allocation_hooks::_free(memory); }
+#endif //EULERISTIC_JSON_ALLOCATION_HOOKS_IMPLEMENTATION
 
 #undef PUSH_TO_COUT
+#undef TIME_STATISTIC
@@ -0,0 +1,61 @@
+// What the tests share. Each test is a program which runs its checks, prints those which failed, and exits with their number.
+// Macros which configure euleristic_json.hpp, such as EULERISTIC_JSON_SERIALIZATION_CACHE, are defined before this is included.
+
+#pragma once
+#include "euleristic_json.hpp"
+#include <iostream>
+#include <sstream>
+
+namespace test {
+
+	namespace json = euleristic::json;
+	using value_t = json::value_type<long long, double, std::string>;
+
+	inline int failures = 0;
+
+	// Counts and prints the check unless condition holds.
+	inline void check(const bool condition, const std::string_view description) {
+		if (!condition) {
+			std::cout << "FAILED: " << description << '\n';
+			++failures;
+		}
+	}
+
+	// Whether function throws error, which is compared with what is thrown: an enumerator such as interface_misuse::INCORRECT_TYPE,
+	// or for parsing_error, its type.
+	template <typename function_type, typename error_type>
+	bool throws(function_type&& function, const error_type error) {
+		try {
+			function();
+		}
+		catch (const json::parsing_error& thrown) {
+			if constexpr (std::is_same_v<error_type, json::parsing_error::type_t>) {
+				return thrown.type == error;
+			}
+			return false;
+		}
+		catch (const error_type thrown) {
+			return thrown == error;
+		}
+		catch (...) {
+			return false;
+		}
+		return false;
+	}
+
+	inline value_t parse(const std::string_view text) {
+		return json::parse_text<long long, double, std::string>(text);
+	}
+
+	inline std::string to_text(const value_t& value) {
+		std::ostringstream stream;
+		stream << value;
+		return std::move(stream).str();
+	}
+
+	// Prints the outcome, and returns what main returns.
+	inline int report() {
+		std::cout << (failures == 0 ? "All checks passed.\n" : "Some checks failed.\n");
+		return failures;
+	}
+}
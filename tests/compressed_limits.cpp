@@ -0,0 +1,89 @@
+// Tests that parse_file enforces the limits of parse_options on a compressed file while it is decompressed, also on a string
+// which is too long or never ends, whose text is held back until it can be tokenized, and that tokens which straddle many chunks are parsed whole.
+// Build and run from the root of the repository, linking zlib:
+//     g++ -std=c++20 -pthread -I. tests/compressed_limits.cpp -o compressed_limits -lz && ./compressed_limits
+
+#define EULERISTIC_JSON_ZLIB
+#include "check.hpp"
+#include <filesystem>
+
+using namespace test;
+
+namespace {
+
+	const auto path = std::filesystem::temp_directory_path() / "euleristic_json_compressed_limits_test.json.gz";
+
+	// Writes text to path through gzip, without going through the header.
+	void write_compressed(const std::string& text) {
+		gzFile file = gzopen(path.string().c_str(), "wb");
+		gzwrite(file, text.data(), static_cast<unsigned>(text.size()));
+		gzclose(file);
+	}
+
+	bool exceeds(const std::string& text, const json::parse_options& options) {
+		write_compressed(text);
+		return throws([&] { (void)json::parse_file<long long, double, std::string>(path, options); }, json::parsing_error::type_t::LIMIT_EXCEEDED);
+	}
+
+	// 16 MiB of text, which compresses to a few KiB.
+	const std::string long_text(size_t(16) << 20, 'x');
+
+	void long_strings() {
+		json::parse_options bytes;
+		bytes.max_bytes = size_t(1) << 20;
+		json::parse_options length;
+		length.max_string_length = 1000;
+
+		check(exceeds("[\"" + long_text + "\"]", bytes), "a string longer than max_bytes exceeds it");
+		check(exceeds("[\"" + long_text, bytes), "a string which never ends exceeds max_bytes before the source ends");
+		check(exceeds("[\"" + long_text + "\"]", length), "a string longer than max_string_length exceeds it");
+		check(exceeds("[\"" + long_text, length), "a string which never ends exceeds max_string_length before the source ends");
+
+		// Escapes take six bytes for one code unit, so the text of a string may be six times as long as max_string_length.
+		std::string escaped = "[\"";
+		for (size_t i = 0; i < 100000; ++i) {
+			escaped += "\\u0041";
+		}
+		escaped += "\",1]";
+		length.max_string_length = 100000;
+		write_compressed(escaped);
+		try {
+			auto value = json::parse_file<long long, double, std::string>(path, length);
+			check(value[0].as_string().size() == 100000, "an escaped string within max_string_length is parsed");
+		}
+		catch (json::parsing_error) {
+			check(false, "an escaped string within max_string_length is parsed");
+		}
+	}
+
+	// Text held back is only tokenized again once it has doubled, so the tokens after a long one, in the chunk which finishes it
+	// or in those after it, must still be found, and must not count against the limits of the long one.
+	void long_tokens() {
+		std::string escaped;
+		for (size_t i = 0; i < 400000; ++i) {
+			escaped += "\\u0041";
+		}
+		json::parse_options length;
+		length.max_string_length = 400000;
+		write_compressed("[\"" + escaped + "\",1,[\"" + escaped + "\"],\"" + long_text.substr(0, 1000) + "\"]");
+		try {
+			auto value = json::parse_file<long long, double, std::string>(path, length);
+			check(value[0].as_string().size() == 400000 && value[1].as_integer() == 1 && value[2][0].as_string().size() == 400000
+				&& value[3].as_string().size() == 1000, "strings which straddle many chunks, and the values after them, are parsed whole");
+		}
+		catch (json::parsing_error) {
+			check(false, "strings which straddle many chunks, and the values after them, are parsed whole");
+		}
+
+		write_compressed("[\"" + long_text + "\",2]");
+		auto value = json::parse_file<long long, double, std::string>(path);
+		check(value[0].as_string().size() == long_text.size() && value[1].as_integer() == 2, "a string of many chunks is parsed whole");
+	}
+}
+
+int main() {
+	long_strings();
+	long_tokens();
+	std::filesystem::remove(path);
+	return report();
+}
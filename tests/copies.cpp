@@ -0,0 +1,141 @@
+// Tests that copies of a value_type are left as they were when the value is modified, also after deduplicate, that a value may be assigned
+// a value within it, and that copies share its arrays and objects only with EULERISTIC_JSON_COPY_ON_WRITE, which tests/copy_on_write.cpp defines before including this.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -I. tests/copies.cpp -o copies && ./copies
+
+#include "check.hpp"
+
+using namespace test;
+
+namespace {
+
+	void modifications_of_the_original() {
+		auto document = parse(R"({"a":{"x":1},"b":[1,[2,3]]})");
+		const auto copy = document;
+		document.mutable_at("a").insert_or_assign("y", value_t(2ll));
+		document.mutable_at("b").mutable_at(1).push_back(value_t(4ll));
+		check(copy == parse(R"({"a":{"x":1},"b":[1,[2,3]]})"), "a copy is left as it was when the original is modified");
+		check(document == parse(R"({"a":{"x":1,"y":2},"b":[1,[2,3,4]]})"), "the original is modified");
+	}
+
+	void modifications_of_the_copy() {
+		const auto document = parse(R"([[1],[2]])");
+		auto copy = document;
+		copy.mutable_at(0).push_back(value_t(5ll));
+		check(document == parse(R"([[1],[2]])"), "the original is left as it was when a copy is modified");
+		check(copy == parse(R"([[1,5],[2]])"), "the copy is modified");
+	}
+
+	// With EULERISTIC_JSON_COPY_ON_WRITE, copying ends references from mutable_at, so they are taken again after copies.
+	void references_around_copies() {
+		auto document = parse(R"({"a":{"x":1},"b":[1,{"c":2}]})");
+		auto& a = document.mutable_at("a");
+		a.insert_or_assign("y", value_t(2ll));
+		const auto copy = document;
+		document.mutable_at("a").insert_or_assign("z", value_t(3ll));
+		check(copy == parse(R"({"a":{"x":1,"y":2},"b":[1,{"c":2}]})"), "a copy holds what was written through a reference before it, but not through one taken after it");
+
+		auto& c = document.mutable_at("b").mutable_at(1);
+		auto& first = document.mutable_at("b").mutable_at(0);
+		first = value_t(5ll);
+		c.insert_or_assign("d", value_t(4ll));
+		check(document == parse(R"({"a":{"x":1,"y":2,"z":3},"b":[5,{"c":2,"d":4}]})"), "calling mutable_at again leaves earlier references valid");
+
+		value_t assigned;
+		assigned = document;
+		document.mutable_at("b").mutable_at(1).erase("c");
+		check(assigned == parse(R"({"a":{"x":1,"y":2,"z":3},"b":[5,{"c":2,"d":4}]})"), "a value assigned is left as it was when a reference taken after it is written through");
+		check(document == parse(R"({"a":{"x":1,"y":2,"z":3},"b":[5,{"d":4}]})"), "writes through references modify the original");
+
+#ifndef EULERISTIC_JSON_COPY_ON_WRITE
+		auto& kept = document.mutable_at("a");
+		const auto deep = document;
+		kept.erase("x");
+		check(deep == parse(R"({"a":{"x":1,"y":2,"z":3},"b":[5,{"d":4}]})") && kept == parse(R"({"y":2,"z":3})"), "without the macro, a reference kept across a copy is valid, and writes through it do not show in the copy");
+#endif //EULERISTIC_JSON_COPY_ON_WRITE
+	}
+
+	// Assigning a value one of its own elements frees what held the element, which must have been copied first.
+	void assignments_from_within() {
+		auto array = parse(R"([{"a":[1,2]},3])");
+		array = array[0];
+		check(array == parse(R"({"a":[1,2]})"), "a value may be assigned an element of its own");
+
+		auto object = parse(R"({"child":{"x":[1,{"y":2}]},"other":1})");
+		object = object["child"]["x"];
+		check(object == parse(R"([1,{"y":2}])"), "a value may be assigned a value nested within it");
+
+		auto scalar = parse(R"({"a":"a string too long to be held within std::string itself"})");
+		scalar = scalar["a"];
+		check(scalar == value_t("a string too long to be held within std::string itself"), "a value may be assigned a string within it");
+
+		auto self = parse(R"([1,[2]])");
+		const auto& alias = self;
+		self = alias;
+		check(self == parse(R"([1,[2]])"), "a value may be assigned itself");
+	}
+
+	// Arrays and objects deduplicate has shared are copied, and taken apart again as they are modified, like any other.
+	void deduplicated_values() {
+		auto document = parse(R"([{"a":[1,2]},{"a":[1,2]},{"a":[1,2]}])");
+		json::deduplicate(document);
+		check(&document[0]["a"] == &document[1]["a"], "deduplicate shares identical objects");
+		const auto copy = document;
+		document.mutable_at(1).mutable_at("a").push_back(value_t(3ll));
+		check(document == parse(R"([{"a":[1,2]},{"a":[1,2,3]},{"a":[1,2]}])"), "modifying a shared object leaves the others sharing it as they were");
+		check(copy == parse(R"([{"a":[1,2]},{"a":[1,2]},{"a":[1,2]}])"), "a copy of a deduplicated value is left as it was");
+		check(&document[0]["a"] == &document[2]["a"], "the others still share the object");
+	}
+
+	// deduplicate only copies what copies share on the way to what it replaces, and subtracts those copies from what it frees.
+	void deduplicated_snapshots() {
+#ifdef EULERISTIC_JSON_COPY_ON_WRITE
+		constexpr bool shared = true;
+#else
+		constexpr bool shared = false;
+#endif
+		auto document = parse(R"({"unique":{"x":[1,2]},"twins":[{"b":[3]},{"b":[3]}]})");
+		const auto snapshot = document;
+		const size_t freed = json::deduplicate(document);
+		check(&document["twins"][0]["b"] == &document["twins"][1]["b"], "deduplicate shares identical objects of a value a copy is taken of");
+		check((&snapshot["unique"]["x"] == &document["unique"]["x"]) == shared, "arrays and objects with nothing replaced in them are still shared with the copy");
+		check((freed == 0) == shared, "nothing is freed while a copy holds the replaced object");
+		check(snapshot == document && snapshot == parse(R"({"unique":{"x":[1,2]},"twins":[{"b":[3]},{"b":[3]}]})"), "the copy is left as it was");
+		check(json::deduplicate(document) == 0 && &document["twins"][0]["b"] == &document["twins"][1]["b"], "deduplicating again leaves what is shared as it is");
+	}
+
+	// Elements are at the same address in two values exactly when they share the array or object holding them.
+	void sharing() {
+#ifdef EULERISTIC_JSON_COPY_ON_WRITE
+		constexpr bool shared = true;
+#else
+		constexpr bool shared = false;
+#endif
+		auto document = parse(R"({"a":[1],"b":{"c":2}})");
+		const auto copy = document;
+		check((&copy["a"] == &document["a"]) == shared, "copies share arrays and objects exactly with EULERISTIC_JSON_COPY_ON_WRITE");
+
+		document.mutable_at("a").push_back(value_t(2ll));
+		document.mutable_at("b").mutable_at("c") = value_t(3ll);
+		const auto first = document;
+		check((&first["a"] == &document["a"]) == shared, "copies made after mutable_at still share arrays and objects exactly with the macro");
+		check((&first["b"]["c"] == &document["b"]["c"]) == shared, "copies made after nested calls of mutable_at still share nested objects exactly with the macro");
+		const auto second = first;
+		check(&second["b"]["c"] == &first["b"]["c"] || !shared, "copies of copies share too");
+		document.mutable_at("a").push_back(value_t(4ll));
+		check(first == second && second == parse(R"({"a":[1,2],"b":{"c":3}})"), "copies are left as they were when a reference taken after them is written through");
+		check(copy == parse(R"({"a":[1],"b":{"c":2}})"), "the first copy is left as it was");
+		check(document == parse(R"({"a":[1,2,4],"b":{"c":3}})"), "the original is modified");
+	}
+}
+
+int main() {
+	modifications_of_the_original();
+	modifications_of_the_copy();
+	references_around_copies();
+	assignments_from_within();
+	deduplicated_values();
+	deduplicated_snapshots();
+	sharing();
+	return report();
+}
@@ -0,0 +1,6 @@
+// Runs the tests of tests/copies.cpp with EULERISTIC_JSON_COPY_ON_WRITE, so that copies share arrays and objects.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -I. tests/copy_on_write.cpp -o copy_on_write && ./copy_on_write
+
+#define EULERISTIC_JSON_COPY_ON_WRITE
+#include "copies.cpp"
@@ -0,0 +1,117 @@
+// Tests that json_patch::apply leaves the target as it was when an operation fails part way through a patch,
+// that it moves values rather than copying them, and that test operations compare numbers by value.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -I. tests/json_patch.cpp -o json_patch && ./json_patch
+
+#include "check.hpp"
+#include <random>
+
+using namespace test;
+using patch_t = json::json_patch<long long, double, std::string>;
+
+namespace {
+
+	// Applies patch to a copy of target, and returns whether it failed and left the copy equal to target.
+	bool rolled_back(const std::string_view target, const std::string_view patch) {
+		const auto original = parse(target);
+		auto patched = original;
+		try {
+			patch_t(parse(patch)).apply(patched);
+		}
+		catch (json::interface_misuse) {
+			return patched == original;
+		}
+		return false;
+	}
+
+	void failed_moves() {
+		check(rolled_back(R"({"a":1})", R"([{"op":"move","from":"/a","path":"/nonexistent/x"}])"),
+			"a move to a path which does not exist puts the member back");
+		check(rolled_back(R"({"b":[1,2,3]})", R"([{"op":"move","from":"/b/0","path":"/b/9"}])"),
+			"a move to an index out of range puts the element back");
+		check(rolled_back(R"({"a":{"x":[1]},"b":2})", R"([{"op":"move","from":"/a","path":"/b/c"}])"),
+			"a move into a value which is not an array or object puts the value back");
+		check(rolled_back(R"({"a":1,"b":{}})", R"([{"op":"move","from":"/a","path":"/b/a"},{"op":"move","from":"/b/a","path":"/c/a"}])"),
+			"a failed move after a successful one puts both values back");
+		check(rolled_back(R"({"a":[1,2],"b":[]})", R"([{"op":"move","from":"/a/0","path":"/b/-"},{"op":"test","path":"/a","value":[]}])"),
+			"a failed test after a move puts the moved value back");
+	}
+
+	// Whether a patch of a single test of value at path succeeds against target.
+	bool passes(const std::string_view target, const std::string_view path, const std::string_view value) {
+		auto patched = parse(target);
+		try {
+			patch_t(parse(R"([{"op":"test","path":")" + std::string(path) + R"(","value":)" + std::string(value) + "}]")).apply(patched);
+		}
+		catch (json::interface_misuse) {
+			return false;
+		}
+		return true;
+	}
+
+	// RFC 6902 compares numbers by their values, whether they are written as integers or not.
+	void numeric_tests() {
+		check(passes(R"({"a":1})", "/a", "1.0"), "an integer equals a floating point number of the same value");
+		check(passes(R"({"a":1.0})", "/a", "1"), "a floating point number equals an integer of the same value");
+		check(passes(R"({"a":[1,{"b":-2.0}]})", "/a", R"([1.0,{"b":-2}])"), "numbers are compared by value within arrays and objects");
+		check(!passes(R"({"a":1})", "/a", "1.5"), "an integer does not equal a floating point number of another value");
+		check(!passes(R"({"a":9007199254740993})", "/a", "9007199254740992.0"), "an integer does not equal the nearest floating point number to it");
+		check(!passes(R"({"a":9223372036854775807})", "/a", "9223372036854775808.0"), "an integer does not equal a floating point number past its range");
+		check(!passes(R"({"a":[1]})", "/a", R"([1,1])"), "arrays of different lengths are not equal");
+		check(!passes(R"({"a":"1"})", "/a", "1"), "a string does not equal a number");
+	}
+
+	// A moved value keeps its arrays and objects, so its elements stay where they were, which a copy would not.
+	void moves_without_copying() {
+		std::string big = "[";
+		for (int i = 0; i < 10000; ++i) {
+			big += std::to_string(i) + ',';
+		}
+		big.back() = ']';
+		auto target = parse(R"({"a":{"big":)" + big + R"(},"b":{}})");
+		const auto* element = &target["a"]["big"][0];
+		patch_t(parse(R"([{"op":"move","from":"/a/big","path":"/b/big"}])")).apply(target);
+		check(&target["b"]["big"][0] == element, "a move does not copy the moved value");
+		check(target == parse(R"({"a":{},"b":{"big":)" + big + "}}"), "a move moves the value");
+	}
+
+	// Paths into the documents of random_patches, some of which do not exist.
+	const char* paths[] = { "", "/a", "/a/0", "/a/1", "/a/-", "/a/9", "/b", "/b/x", "/b/y", "/b/x/0", "/c", "/c/z", "/d" };
+	const char* values[] = { "1", "null", "\"s\"", "[1,2]", "{\"k\":true}" };
+
+	// Applies random patches ending in a failing test, which every one of them must be rolled back from.
+	void random_patches() {
+		std::mt19937_64 random(1);
+		const char* operations[] = { "add", "remove", "replace", "move", "copy" };
+		const auto target = R"({"a":[1,{"n":2},3],"b":{"x":[4],"y":"five"},"c":null})";
+		for (int round = 0; round < 2000; ++round) {
+			std::string patch = "[";
+			const size_t count = 1 + random() % 6;
+			for (size_t i = 0; i < count; ++i) {
+				const std::string operation = operations[random() % std::size(operations)];
+				patch += R"({"op":")" + operation + R"(","path":")" + paths[random() % std::size(paths)] + '"';
+				if (operation == "move" || operation == "copy") {
+					patch += R"(,"from":")" + std::string(paths[random() % std::size(paths)]) + '"';
+				}
+				if (operation == "add" || operation == "replace") {
+					patch += R"(,"value":)" + std::string(values[random() % std::size(values)]);
+				}
+				patch += "},";
+			}
+			patch += R"({"op":"test","path":"","value":0}])";
+			if (!rolled_back(target, patch)) {
+				check(false, "a random patch which fails is rolled back");
+				std::cout << "    " << patch << '\n';
+				return;
+			}
+		}
+	}
+}
+
+int main() {
+	failed_moves();
+	moves_without_copying();
+	numeric_tests();
+	random_patches();
+	return report();
+}
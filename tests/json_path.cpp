@@ -0,0 +1,74 @@
+// Tests the function extensions of json_path, length(), count(), match(), search() and value(), that calls which are not well typed are rejected,
+// and that filters compare arrays and objects with numbers equal by value.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -I. tests/json_path.cpp -o json_path && ./json_path
+
+#include "check.hpp"
+
+using namespace test;
+using path_t = json::json_path<std::string>;
+
+namespace {
+
+	// The texts of the values the query selects from document, one after another.
+	std::string selected(const value_t& document, const char* query) {
+		std::string texts;
+		for (auto value : path_t(query).execute(document)) {
+			texts += to_text(*value) + ' ';
+		}
+		return texts;
+	}
+
+	void functions() {
+		const auto document = parse(R"([{"n":"abc","t":[1,2,3]},{"n":"x","t":[1]},{"n":"déf","t":[]},{"n":"no","t":{"a":2}}])");
+		check(selected(document, "$[?length(@.n) == 3].n") == R"("abc" "déf" )", "length counts characters, taking a UTF-8 sequence as one");
+		check(path_t("$[?length(@) == 3]").execute(parse(R"(["d\u00e9f"])")).size() == 1, "length takes a byte which begins no UTF-8 sequence as a character of its own");
+		check(selected(document, "$[?length(@.t) == 1].n") == R"("x" "no" )", "length counts the elements of arrays and objects");
+		check(selected(document, "$[?length(@.missing) == 0]").empty() && selected(document, "$[?length(1) == 1]").empty(), "nothing, and numbers, have no length");
+		check(selected(document, "$[?count(@.t[*]) > 1].n") == R"("abc" )", "count counts the nodes a query selects");
+		check(selected(document, "$[?count(@..*) == 2].n") == R"("déf" )", "count counts descendants");
+		check(selected(document, "$[?value(@.t[0]) == 1].n") == R"("abc" "x" )", "value is the value of the one node its query selects");
+		check(selected(document, "$[?value(@.t[*]) == 1].n") == R"("x" )", "value is nothing if its query selects more than one node");
+		check(selected(document, "$[?length(value(@.n)) == length('xyz')].n") == selected(document, "$[?length(@.n) == 3].n"), "functions which return values may be passed to those which take them");
+	}
+
+	void patterns() {
+		const auto document = parse(R"(["abc","a.c","abbbc","ac","xabcx","a\nc","b",1,"2024-05-17"])");
+		check(selected(document, "$[?match(@, 'a.c')]") == R"("abc" "a.c" )", "match matches the whole string, and . any character but a line break");
+		check(selected(document, "$[?search(@, 'a.c')]") == R"("abc" "a.c" "xabcx" )", "search matches any part of the string");
+		check(selected(document, "$[?match(@, 'ab{2,3}c|ac')]") == R"("abbbc" "ac" )", "counted repetitions and alternatives");
+		check(selected(document, "$[?match(@, 'a[b.]*c')]") == R"("abc" "a.c" "abbbc" "ac" )", "classes and stars");
+		check(selected(document, "$[?match(@, '[^a-c]+')]") == R"("2024-05-17" )", "negated classes with ranges");
+		check(selected(document, "$[?match(@, 'a\\\\nc')]") == "\"a\\nc\" ", "escapes of line breaks");
+		check(selected(document, "$[?match(@, '[0-9]{4}-[0-9]{2}-..')]") == R"("2024-05-17" )", "the example of RFC 9535");
+		check(selected(document, "$[?!search(@, 'b')]") == R"("a.c" "ac" "a\nc" 1 "2024-05-17" )", "match and search may be negated, and are false for other than strings");
+		check(selected(document, "$[?search(@, $[6])]") == R"("abc" "abbbc" "xabcx" "b" )", "patterns may be queries");
+		check(selected(document, "$[?search(@, '\\\\p{L}')]").empty() && selected(document, "$[?search(@, 'a**')]").empty() && selected(document, "$[?search(@, '(a')]").empty(),
+			"invalid patterns, and character properties, match nothing");
+		check(selected(document, "$[?match(@, '(a*)*b')]") == R"("b" )", "empty loops end");
+
+		json::json_path<std::wstring> wide(L"$[?match(@, 'é+')]");
+		check(wide.execute(json::parse_text<long long, double, std::wstring>(R"(["\u00e9\u00e9", "e"])")).size() == 1, "wide strings");
+	}
+
+	void well_typed() {
+		for (auto query : { "$[?length(@.a[*]) > 1]", "$[?count(1) > 1]", "$[?length(@)]", "$[?count(@.a)]", "$[?match(@, 'a') == true]",
+			"$[?foo(@)]", "$[?match(@)]", "$[?length(@, @)]", "$[?count(@.a) > match(@, 'a')]" }) {
+			check(throws([query] { path_t{ query }; }, json::parsing_error::type_t::UNEXPECTED_TOKEN), query);
+		}
+	}
+
+	// Arrays and objects are equal when their numbers are equal in value, as for JSON Patch.
+	void structured_equality() {
+		const auto document = parse(R"({"list":[[1],[1.0],[2]],"one":[1.0]})");
+		check(selected(document, "$.list[?@ == $.one]") == "[\n\t1\n] [\n\t1.000000\n] ", "filters compare arrays with numbers equal by value");
+	}
+}
+
+int main() {
+	functions();
+	patterns();
+	well_typed();
+	structured_equality();
+	return report();
+}
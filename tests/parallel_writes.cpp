@@ -0,0 +1,97 @@
+// Tests that write_to_file_parallel writes what write_to_file writes, opens its file as write_to_file does for the same write_options,
+// and leaves neither a truncated file nor a temporary one behind when it fails.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -pthread -I. tests/parallel_writes.cpp -o parallel_writes && ./parallel_writes
+
+#define EULERISTIC_JSON_PARALLEL_WRITES
+#if __has_include(<sys/uio.h>)
+#define EULERISTIC_JSON_POSIX_IO
+#endif //__has_include(<sys/uio.h>)
+#include "check.hpp"
+#include <filesystem>
+#include <fstream>
+#if __has_include(<sys/resource.h>)
+#include <sys/resource.h>
+#include <csignal>
+#endif //__has_include(<sys/resource.h>)
+
+using namespace test;
+
+namespace {
+
+	const auto directory = std::filesystem::temp_directory_path() / "euleristic_json_parallel_writes_test";
+
+	std::string read(const std::filesystem::path& path) {
+		std::ifstream file(path, std::ios::binary);
+		return { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+	}
+
+	// An array heavy enough to be split into many pieces.
+	value_t large_value() {
+		std::vector<value_t> elements;
+		for (long long i = 0; i < 100000; ++i) {
+			elements.push_back(value_t(std::unordered_map<std::string, value_t>{ { "index", value_t(i) }, { "values", value_t(std::vector<value_t>{ value_t(i * 0.5), value_t("text") }) } }));
+		}
+		return value_t(std::move(elements));
+	}
+
+	void same_output() {
+		const auto value = large_value();
+		json::write_to_file(value, directory / "serial.json");
+		const auto expected = read(directory / "serial.json");
+
+		json::write_to_file_parallel(value, directory / "parallel.json", 4);
+		check(read(directory / "parallel.json") == expected, "write_to_file_parallel writes what write_to_file writes");
+
+		json::write_options atomic;
+		atomic.atomic = true;
+		json::write_to_file_parallel(value, directory / "parallel.json", atomic, 4);
+		check(read(directory / "parallel.json") == expected, "an atomic write_to_file_parallel writes what write_to_file writes");
+
+		json::write_options direct;
+		direct.direct = true;
+		direct.buffer_size = 4096;
+		direct.expected_size = expected.size() * 2;
+		json::write_to_file_parallel(value, directory / "direct.json", direct, 4);
+		check(read(directory / "direct.json") == expected, "a direct write_to_file_parallel with space reserved writes what write_to_file writes");
+	}
+
+	// Files are limited to 64 KiB, which the value is far larger than, so that writing it fails part way, as on a full disk.
+	void failed_writes() {
+#if __has_include(<sys/resource.h>)
+		const auto path = directory / "existing.json";
+		std::ofstream(path) << "[1,2,3]";
+		const auto value = large_value();
+
+		std::signal(SIGXFSZ, SIG_IGN);
+		rlimit limit;
+		::getrlimit(RLIMIT_FSIZE, &limit);
+		const rlimit small{ 1 << 16, limit.rlim_max };
+		::setrlimit(RLIMIT_FSIZE, &small);
+
+		json::write_options atomic;
+		atomic.atomic = true;
+		check(throws([&] { json::write_to_file_parallel(value, path, atomic, 4); }, json::format_error::FILE_WRITE_ERROR), "a write which fails part way throws FILE_WRITE_ERROR");
+		check(read(path) == "[1,2,3]", "an atomic write which fails part way leaves the file as it was");
+		check(throws([&] { json::write_to_file_parallel(value, path, 4); }, json::format_error::FILE_WRITE_ERROR)
+			&& throws([&] { json::write_to_file(value, path); }, json::format_error::FILE_WRITE_ERROR), "a write which is not atomic fails as write_to_file does");
+
+		::setrlimit(RLIMIT_FSIZE, &limit);
+
+		size_t files = 0;
+		for ([[maybe_unused]] auto& entry : std::filesystem::directory_iterator(directory)) {
+			++files;
+		}
+		check(files == 4, "a failed atomic write leaves no temporary file behind");
+#endif //__has_include(<sys/resource.h>)
+	}
+}
+
+int main() {
+	std::filesystem::remove_all(directory);
+	std::filesystem::create_directories(directory);
+	same_output();
+	failed_writes();
+	std::filesystem::remove_all(directory);
+	return report();
+}
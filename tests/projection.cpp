@@ -0,0 +1,72 @@
+// Tests that parse_text with a projection rejects what plain parse_text rejects, also within the values it skips.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -I. tests/projection.cpp -o projection && ./projection
+
+#include "check.hpp"
+
+using namespace test;
+
+namespace {
+
+	value_t parse_b(const std::string_view text) {
+		return json::parse_text<long long, double, std::string>(text, json::projection<>{ "/b" });
+	}
+
+	// Whether both parses reject text. The type of error may differ, since the full parser tokenizes the whole source first,
+	// and so reports a token it does not know before a token out of place.
+	bool rejected_by_both(const std::string_view text) {
+		auto rejects = [text](auto parse) {
+			try {
+				(void)parse(text);
+			}
+			catch (json::parsing_error) {
+				return true;
+			}
+			return false;
+		};
+		return rejects(parse) && rejects(parse_b);
+	}
+
+	void malformed_skipped_values() {
+		const char* sources[] = {
+			R"({"a": tru, "b": 1})",
+			R"({"a": truex, "b": 1})",
+			R"({"a": nul, "b": 1})",
+			R"({"a": 1x, "b": 1})",
+			R"({"a": x, "b": 1})",
+			R"({"a": [1}, "b": 2})",
+			R"({"a": {"x": 1], "b": 2})",
+			R"({"a": [1 2], "b": 2})",
+			R"({"a": [1,], "b": 2})",
+			R"({"a": [,1], "b": 2})",
+			R"({"a": {"x" 1}, "b": 2})",
+			R"({"a": {x: 1}, "b": 2})",
+			R"({"a": {"x": 1,}, "b": 2})",
+			R"({"a": [[[{"x": [true, false, null]}]]], "b": 2, "c": [1})",
+			R"({"b": 2, "c": [1, {"d": }]})",
+			R"({"b": 2, "c": [)",
+		};
+		for (auto source : sources) {
+			if (!rejected_by_both(source)) {
+				check(false, "a projection rejects malformed skipped values as parse_text does");
+				std::cout << "    " << source << '\n';
+			}
+		}
+	}
+
+	void well_formed_skipped_values() {
+		const auto text = R"({"a": [1, -2.5e+3, "s\"]", {"x": [true, false, null, {}], "y": []}], "b": {"c": [1, 2]}, "d": "}"})";
+		try {
+			check(parse_b(text) == parse(R"({"b": {"c": [1, 2]}})"), "a projection skips well formed values");
+		}
+		catch (json::parsing_error) {
+			check(false, "a projection skips well formed values");
+		}
+	}
+}
+
+int main() {
+	malformed_skipped_values();
+	well_formed_skipped_values();
+	return report();
+}
@@ -0,0 +1,121 @@
+// Tests that values written with the serialization cache are written as they are, after modifications made in any way,
+// and when copies which share containers are written on separate threads at once.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -pthread -I. tests/serialization_cache.cpp -o serialization_cache && ./serialization_cache
+
+#define EULERISTIC_JSON_COPY_ON_WRITE
+#define EULERISTIC_JSON_SERIALIZATION_CACHE
+#include "check.hpp"
+#include <thread>
+
+using namespace test;
+
+namespace {
+
+	// Whether value is written as text which parses to the same as expected.
+	bool written_as(const value_t& value, const std::string_view expected) {
+		return parse(to_text(value)) == parse(expected);
+	}
+
+	void modifications_from_the_root() {
+		auto document = parse(R"({"a":{"b":[1,2]},"c":[3]})");
+		to_text(document);
+		document.mutable_at("a").mutable_at("b").push_back(value_t(4ll));
+		check(written_as(document, R"({"a":{"b":[1,2,4]},"c":[3]})"), "a modification from the root is written");
+		check(written_as(document, R"({"a":{"b":[1,2,4]},"c":[3]})"), "a modification from the root is written from the cache");
+	}
+
+	void modifications_through_kept_references() {
+		auto document = parse(R"({"a":{"x":1},"c":[3]})");
+		auto& a = document.mutable_at("a");
+		to_text(document);
+		a.insert_or_assign("b", value_t(42ll));
+		check(written_as(document, R"({"a":{"x":1,"b":42},"c":[3]})"), "a modification through a kept reference is written");
+
+		auto& x = a.mutable_at("x");
+		to_text(document);
+		x = value_t(7ll);
+		check(written_as(document, R"({"a":{"x":7,"b":42},"c":[3]})"), "an assignment through a kept reference is written");
+
+		auto& element = document.mutable_at("c").mutable_at(0);
+		to_text(document);
+		element = value_t(std::vector<value_t>{ value_t(5ll) });
+		to_text(document);
+		element.push_back(value_t(6ll));
+		check(written_as(document, R"({"a":{"x":7,"b":42},"c":[[5,6]]})"), "a modification of a nested container through a kept reference is written");
+	}
+
+	// Whether writing value caches its text as a whole, rather than only that of the containers within it.
+	bool cached_whole(const value_t& value) {
+		const size_t uncached = value.memory_usage();
+		const size_t written = to_text(value).size();
+		return value.memory_usage() - uncached >= written;
+	}
+
+	// Containers are cached again once the references mutable_at has handed out into them have ended, by a copy or a modification.
+	void caching_after_references_end() {
+		auto document = parse(R"({"a":[1],"s":")" + std::string(1000, 's') + R"("})");
+		document.mutable_at("a").push_back(value_t(2ll));
+		check(!cached_whole(document), "an object with a reference into it is not cached");
+		const auto copy = document;
+		check(cached_whole(document), "an object is cached once a copy has ended the references into it");
+
+		document.mutable_at("a").push_back(value_t(3ll));
+		check(written_as(document, R"({"a":[1,2,3],"s":")" + std::string(1000, 's') + R"("})"), "a modification after a copy is written");
+		check(written_as(copy, R"({"a":[1,2],"s":")" + std::string(1000, 's') + R"("})"), "a modification after a copy does not show in the cached copy");
+		document.insert_or_assign("t", value_t(true));
+		check(cached_whole(document), "an object is cached once a modification has ended the references into it");
+		check(written_as(document, R"({"a":[1,2,3],"s":")" + std::string(1000, 's') + R"(","t":true})"), "an object cached after a modification is written as it is");
+	}
+
+	// Only the outermost container records its text, so nested containers do not each hold a copy of it.
+	void recording_once() {
+		std::string text;
+		for (int i = 0; i < 40; ++i) text += "[";
+		text += R"("a string long enough to be held on the heap")";
+		for (int i = 0; i < 40; ++i) text += "]";
+		const auto document = parse(text);
+		const size_t uncached = document.memory_usage();
+		const size_t written = to_text(document).size();
+		check(document.memory_usage() - uncached < written + 256, "writing a nested value caches its text once");
+		check(to_text(document) == to_text(parse(text)), "a nested value is written from the cache as it was rendered");
+	}
+
+	// A value and a copy sharing its containers, written on separate threads at once, fill and read the same caches.
+	void concurrent_writes() {
+		std::string text = "[";
+		for (int i = 0; i < 200; ++i) {
+			text += (i ? "," : "") + std::string(R"({"index":)") + std::to_string(i) + R"(,"values":[1,2,{"deep":[true,null]}]})";
+		}
+		text += "]";
+		const auto expected = to_text(parse(text));
+
+		for (int round = 0; round < 20; ++round) {
+			const auto document = parse(text);
+			const auto copy = document;
+			bool same[2] = { true, true };
+			auto write = [&](const value_t& value, bool& result) {
+				for (int i = 0; i < 20; ++i) {
+					result = result && to_text(value) == expected;
+				}
+			};
+			std::thread first(write, std::cref(document), std::ref(same[0]));
+			std::thread second(write, std::cref(copy), std::ref(same[1]));
+			first.join();
+			second.join();
+			if (!same[0] || !same[1]) {
+				check(false, "a value and its copy written on separate threads at once are written as they are");
+				return;
+			}
+		}
+	}
+}
+
+int main() {
+	modifications_from_the_root();
+	modifications_through_kept_references();
+	caching_after_references_end();
+	recording_once();
+	concurrent_writes();
+	return report();
+}
@@ -0,0 +1,104 @@
+// Tests array_reader and document_stream on sources larger than the chunks they are read and tokenized in.
+// Build and run from the root of the repository:
+//     g++ -std=c++20 -I. tests/streaming.cpp -o streaming && ./streaming
+
+#include "check.hpp"
+
+using namespace test;
+
+namespace {
+
+	// The i:th of the documents, of about 60 bytes each, so that many of them straddle the boundaries of 1 MiB chunks.
+	value_t document(const size_t i) {
+		return value_t(std::unordered_map<std::string, value_t>{
+			{ "index", value_t(static_cast<long long>(i)) },
+			{ "name", value_t("document number " + std::to_string(i)) },
+			{ "values", value_t(std::vector<value_t>{ value_t(1.5), value_t(nullptr), value_t(true) }) }
+		});
+	}
+
+	constexpr size_t count = 50000;
+
+	void document_stream_across_chunks() {
+		std::string source;
+		for (size_t i = 0; i < count; ++i) {
+			source += to_text(document(i));
+		}
+		check(source.size() > 2 * (size_t(1) << 20), "the source spans several chunks");
+
+		size_t i = 0;
+		try {
+			for (auto& value : json::document_stream<long long, double, std::string>(source)) {
+				if (!(value == document(i))) {
+					check(false, "document_stream of a string_view gives every document intact");
+					return;
+				}
+				++i;
+			}
+		}
+		catch (json::parsing_error) {
+			check(false, "document_stream of a string_view does not fail on a document which straddles a chunk boundary");
+		}
+		check(i == count, "document_stream of a string_view gives every document");
+
+		std::istringstream stream(source);
+		i = 0;
+		try {
+			for (auto& value : json::document_stream<long long, double, std::string>(stream)) {
+				if (!(value == document(i))) {
+					check(false, "document_stream of a stream gives every document intact");
+					return;
+				}
+				++i;
+			}
+		}
+		catch (json::parsing_error) {
+			check(false, "document_stream of a stream does not fail on a document which straddles a chunk boundary");
+		}
+		check(i == count, "document_stream of a stream gives every document");
+	}
+
+	void array_reader_across_chunks() {
+		std::vector<value_t> elements;
+		for (size_t i = 0; i < count; ++i) {
+			elements.push_back(document(i));
+		}
+		// An element longer than a whole chunk, one which straddles many chunks, which are only tokenized again once what is carried
+		// over has doubled, and an element after them.
+		elements.push_back(value_t(std::string((size_t(3) << 20) / 2, 'x')));
+		elements.push_back(value_t(std::string(size_t(9) << 20, 'y')));
+		elements.push_back(document(count));
+
+		// Strings are written as they are, since writing the long ones through operator<< would take long.
+		std::string source = "[";
+		for (auto& element : elements) {
+			source += (element.type() == value_t::type_t::STRING ? '"' + element.as_string() + '"' : to_text(element)) + ',';
+		}
+		source.back() = ']';
+
+		const auto path = std::filesystem::temp_directory_path() / "euleristic_json_streaming_test.json";
+		std::ofstream(path, std::ios::binary) << source;
+
+		size_t i = 0;
+		try {
+			for (auto& element : json::array_reader<long long, double, std::string>(path)) {
+				if (i >= elements.size() || !(element == elements[i])) {
+					check(false, "array_reader gives every element intact");
+					break;
+				}
+				++i;
+			}
+		}
+		catch (json::parsing_error) {
+			check(false, "array_reader does not fail on an element which straddles a chunk boundary");
+		}
+		check(i == elements.size(), "array_reader gives every element");
+		std::filesystem::remove(path);
+	}
+}
+
+int main() {
+	document_stream_across_chunks();
+	array_reader_across_chunks();
+	return report();
+}